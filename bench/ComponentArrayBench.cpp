@@ -0,0 +1,138 @@
+// ComponentArray のベンチマーク（旧 unordered_map 実装と疎集合実装の比較）
+#include "Engine/ECS/ComponentManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    struct Vec3 {
+        float x, y, z;
+    };
+
+    // 旧実装: 2つの unordered_map でエンティティとインデックスを対応付ける
+    // 固定長配列のままでは 5000 を超えられないため、密配列だけ容量指定にしている
+    template<typename T>
+    class LegacyComponentArray {
+    public:
+        explicit LegacyComponentArray(std::size_t capacity) : componentArray(capacity) {}
+
+        void insertData(ECS::Entity entity, T component) {
+            entityToIndexMap[entity] = size;
+            indexToEntityMap[size] = entity;
+            componentArray[size] = component;
+            ++size;
+        }
+
+        void removeData(ECS::Entity entity) {
+            size_t indexOfRemovedEntity = entityToIndexMap[entity];
+            size_t indexOfLastElement = size - 1;
+            componentArray[indexOfRemovedEntity] = componentArray[indexOfLastElement];
+
+            ECS::Entity lastEntity = indexToEntityMap[indexOfLastElement];
+            entityToIndexMap[lastEntity] = indexOfRemovedEntity;
+            indexToEntityMap[indexOfRemovedEntity] = lastEntity;
+
+            entityToIndexMap.erase(entity);
+            indexToEntityMap.erase(indexOfLastElement);
+
+            --size;
+        }
+
+        T& getData(ECS::Entity entity) {
+            return componentArray[entityToIndexMap[entity]];
+        }
+
+        bool hasData(ECS::Entity entity) const {
+            return entityToIndexMap.find(entity) != entityToIndexMap.end();
+        }
+
+    private:
+        std::vector<T> componentArray;
+        std::unordered_map<ECS::Entity, size_t> entityToIndexMap{};
+        std::unordered_map<size_t, ECS::Entity> indexToEntityMap{};
+        size_t size{};
+    };
+
+    struct Timings {
+        double insertMs;
+        double lookupMs;
+        double removeMs;
+        float checksum;
+    };
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // システムの更新ループと同じく hasData + getData を1エンティティずつ行う
+    template<typename Array>
+    Timings run(Array& array, const std::vector<ECS::Entity>& order, int lookupPasses) {
+        Timings timings{};
+
+        auto start = std::chrono::steady_clock::now();
+        for (ECS::Entity entity : order) {
+            array.insertData(entity, Vec3{static_cast<float>(entity), 1.0f, 2.0f});
+        }
+        timings.insertMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        float sum = 0.0f;
+        for (int pass = 0; pass < lookupPasses; ++pass) {
+            for (ECS::Entity entity : order) {
+                if (array.hasData(entity)) {
+                    auto& value = array.getData(entity);
+                    value.y += 0.5f;
+                    sum += value.x + value.y;
+                }
+            }
+        }
+        timings.lookupMs = elapsedMs(start) / lookupPasses;
+
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < order.size(); i += 2) {
+            array.removeData(order[i]);
+        }
+        timings.removeMs = elapsedMs(start);
+
+        timings.checksum = sum;
+        return timings;
+    }
+}
+
+int main() {
+    const std::size_t counts[] = {5000, 100000, 1000000};
+    const int lookupPasses = 10;
+
+    std::printf("%10s %-8s %12s %12s %12s\n", "entities", "impl", "insert(ms)", "lookup(ms)", "remove(ms)");
+
+    for (std::size_t count : counts) {
+        // 生成順どおりではなく、削除と再利用が進んだ状態を模してシャッフルする
+        std::vector<ECS::Entity> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+        LegacyComponentArray<Vec3> legacy(count);
+        Timings legacyTimings = run(legacy, order, lookupPasses);
+
+        ECS::ComponentArray<Vec3> sparse;
+        sparse.reserve(count);
+        Timings sparseTimings = run(sparse, order, lookupPasses);
+
+        std::printf("%10zu %-8s %12.3f %12.3f %12.3f\n", count, "legacy",
+                    legacyTimings.insertMs, legacyTimings.lookupMs, legacyTimings.removeMs);
+        std::printf("%10zu %-8s %12.3f %12.3f %12.3f\n", count, "sparse",
+                    sparseTimings.insertMs, sparseTimings.lookupMs, sparseTimings.removeMs);
+
+        if (legacyTimings.checksum != sparseTimings.checksum) {
+            std::fprintf(stderr, "checksum mismatch at %zu entities\n", count);
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+// 格納方式のベンチマーク（疎集合 + ビューとアーキタイプ + クエリで、3 種類のコンポーネントを走査する）
+#include "Engine/ECS/Coordinator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+    struct Position {
+        float x, y, z;
+    };
+
+    struct Velocity {
+        float x, y, z;
+    };
+
+    struct Morph {
+        float elapsed, duration;
+    };
+
+    // 点群に近い構成: 大半は Position + Velocity、一部が Morph も持ち、残りは Position だけ
+    void populate(ECS::Coordinator& coordinator, std::size_t count) {
+        coordinator.registerComponent<Position>();
+        coordinator.registerComponent<Velocity>();
+        coordinator.registerComponent<Morph>();
+
+        std::vector<ECS::Entity> entities = coordinator.createEntities(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            ECS::Entity entity = entities[i];
+            coordinator.addComponent(entity, Position{static_cast<float>(i), 0.0f, 0.0f});
+            if (i % 10 != 0) {
+                coordinator.addComponent(entity, Velocity{1.0f, 0.5f, 0.25f});
+            }
+            if (i % 4 == 0) {
+                coordinator.addComponent(entity, Morph{0.0f, 2.0f});
+            }
+        }
+    }
+
+    template<typename Func>
+    double elapsedMs(Func&& func, int passes) {
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            func();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / passes;
+    }
+
+    // 走査順は方式によって違うので、検算には訪問数を使う
+    double run(ECS::StorageMode mode, std::size_t count, int passes, std::size_t& visited) {
+        ECS::Coordinator coordinator;
+        coordinator.init(ECS::UNLIMITED_ENTITIES, mode);
+        populate(coordinator, count);
+
+        visited = 0;
+        double ms = elapsedMs([&]() {
+            coordinator.query<Position, Velocity, Morph>().each([&](Position& position, Velocity& velocity, Morph& morph) {
+                morph.elapsed += 0.016f;
+                position.x += velocity.x * 0.016f;
+                ++visited;
+            });
+        }, passes);
+        return ms;
+    }
+}
+
+int main() {
+    const std::size_t counts[] = {100000, 1000000};
+    const int passes = 20;
+
+    std::printf("%10s %-10s %12s\n", "entities", "storage", "iterate(ms)");
+
+    for (std::size_t count : counts) {
+        std::size_t sparseVisited = 0;
+        std::size_t archetypeVisited = 0;
+        double sparseMs = run(ECS::StorageMode::SparseSet, count, passes, sparseVisited);
+        double archetypeMs = run(ECS::StorageMode::Archetype, count, passes, archetypeVisited);
+
+        std::printf("%10zu %-10s %12.3f\n", count, "sparse", sparseMs);
+        std::printf("%10zu %-10s %12.3f\n", count, "archetype", archetypeMs);
+
+        if (sparseVisited != archetypeVisited) {
+            std::fprintf(stderr, "checksum mismatch at %zu entities\n", count);
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
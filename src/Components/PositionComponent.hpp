@@ -1,7 +1,24 @@
-
 #pragma once
 #include <glm/glm.hpp>
+#include "../Engine/ECS/ComponentStorage.hpp"
 
 struct PositionComponent {
     glm::vec3 position;
 };
+
+// SoA で格納したときの参照。position は x[], y[], z[] の各配列の要素を指す
+struct PositionComponentRef {
+    ECS::Float3Ref<glm::vec3> position;
+
+    operator PositionComponent() const {
+        return PositionComponent{position.value()};
+    }
+};
+
+namespace ECS {
+    // 移動・投影のカーネルで成分ごとにまとめて処理できるよう SoA で格納する
+    template<>
+    struct ComponentLayout<PositionComponent> {
+        using Storage = Float3SoAStorage<PositionComponent, &PositionComponent::position, PositionComponentRef>;
+    };
+}
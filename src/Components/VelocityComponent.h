@@ -1,7 +1,23 @@
-
 #pragma once
 #include <glm/glm.hpp>
+#include "../Engine/ECS/ComponentStorage.hpp"
 
 struct VelocityComponent {
     glm::vec3 velocity;
 };
+
+// SoA で格納したときの参照。velocity は x[], y[], z[] の各配列の要素を指す
+struct VelocityComponentRef {
+    ECS::Float3Ref<glm::vec3> velocity;
+
+    operator VelocityComponent() const {
+        return VelocityComponent{velocity.value()};
+    }
+};
+
+namespace ECS {
+    template<>
+    struct ComponentLayout<VelocityComponent> {
+        using Storage = Float3SoAStorage<VelocityComponent, &VelocityComponent::velocity, VelocityComponentRef>;
+    };
+}
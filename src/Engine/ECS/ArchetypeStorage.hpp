@@ -0,0 +1,316 @@
+#pragma once
+
+#include "Types.hpp"
+#include "PagedArray.hpp"
+#include "ComponentStorage.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+    constexpr std::size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+
+    // アーキタイプ方式の格納
+    // 同じシグネチャのエンティティを固定長チャンクにまとめ、チャンク内はコンポーネントごとの列に並べる
+    // チャンクの中身: [Entity × capacity][列0 × capacity][列1 × capacity]...（各列の先頭は境界に揃える）
+    // コンポーネントの追加・削除はエンティティを別のアーキタイプへ移すので、参照はその時点で無効になる
+    class ArchetypeStorage {
+    public:
+        static constexpr std::uint32_t NO_ARCHETYPE = ~std::uint32_t{0};
+
+        ArchetypeStorage() : locations(Location{NO_ARCHETYPE, 0}) {}
+
+        ~ArchetypeStorage() {
+            for (auto& archetype : archetypes) {
+                for (std::size_t row = 0; row < archetype->count; ++row) {
+                    for (std::size_t column = 0; column < archetype->types.size(); ++column) {
+                        columnTypes[archetype->types[column]].destroy(archetype->at(row, column));
+                    }
+                }
+            }
+        }
+
+        ArchetypeStorage(const ArchetypeStorage&) = delete;
+        ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+        template<typename T>
+        void registerComponent(ComponentType type) {
+            ColumnType& column = columnTypes[type];
+            column.size = sizeof(T);
+            column.align = alignof(T);
+            column.relocate = [](void* destination, void* source) {
+                T* from = static_cast<T*>(source);
+                ::new (destination) T(std::move(*from));
+                from->~T();
+            };
+            column.destroy = [](void* pointer) {
+                static_cast<T*>(pointer)->~T();
+            };
+        }
+
+        bool has(Entity entity, ComponentType type) const {
+            const Location& location = locations.get(entity);
+            return location.archetype != NO_ARCHETYPE && archetypes[location.archetype]->signature.test(type);
+        }
+
+        template<typename T>
+        T& get(Entity entity, ComponentType type) {
+            const Location& location = locations[entity];
+            Archetype& archetype = *archetypes[location.archetype];
+            return *static_cast<T*>(archetype.at(location.row, archetype.columnOf[type]));
+        }
+
+        // 複数の型をまとめて追加する。既に持っている型は上書きし、アーキタイプの移動は一度だけ行う
+        template<typename... Ts>
+        void insert(Entity entity, const std::array<ComponentType, sizeof...(Ts)>& types, Ts... components) {
+            Location& location = locations.assure(entity);
+            Signature oldSignature = location.archetype != NO_ARCHETYPE ? archetypes[location.archetype]->signature
+                                                                        : Signature{};
+            Signature newSignature = oldSignature;
+            for (ComponentType type : types) {
+                newSignature.set(type, true);
+            }
+
+            if (newSignature != oldSignature) {
+                moveEntity(entity, newSignature);
+            }
+
+            Archetype& archetype = *archetypes[location.archetype];
+            std::size_t i = 0;
+            ((place<Ts>(archetype, location.row, types[i], oldSignature.test(types[i]), std::move(components)), ++i), ...);
+        }
+
+        void remove(Entity entity, ComponentType type) {
+            if (!has(entity, type)) {
+                return;
+            }
+            Signature signature = archetypes[locations[entity].archetype]->signature;
+            signature.set(type, false);
+            moveEntity(entity, signature);
+        }
+
+        // エンティティが持つすべてのコンポーネントを破棄する
+        void destroy(Entity entity) {
+            if (locations.get(entity).archetype != NO_ARCHETYPE) {
+                moveEntity(entity, Signature{});
+            }
+        }
+
+        // required をすべて持ち、excluded をどれも持たないアーキタイプのチャンクを順に渡す
+        // func(std::size_t count, const Entity* entities, std::array<void*, N> columns)
+        template<std::size_t N, typename Func>
+        void eachChunk(Signature required, Signature excluded, const std::array<ComponentType, N>& types, Func&& func) {
+            for (auto& archetypePointer : archetypes) {
+                Archetype& archetype = *archetypePointer;
+                if (archetype.count == 0 || (archetype.signature & required) != required ||
+                    (archetype.signature & excluded).any()) {
+                    continue;
+                }
+
+                std::array<std::size_t, N> columns{};
+                for (std::size_t i = 0; i < N; ++i) {
+                    columns[i] = archetype.columnOf[types[i]];
+                }
+
+                for (std::size_t chunk = 0; chunk < archetype.chunks.size(); ++chunk) {
+                    std::size_t first = chunk * archetype.capacity;
+                    if (first >= archetype.count) {
+                        break;
+                    }
+                    std::size_t count = std::min(archetype.capacity, archetype.count - first);
+                    std::array<void*, N> pointers{};
+                    for (std::size_t i = 0; i < N; ++i) {
+                        pointers[i] = archetype.column(chunk, columns[i]);
+                    }
+                    func(count, archetype.entities(chunk), pointers);
+                }
+            }
+        }
+
+        std::size_t archetypeCount() const {
+            return archetypes.size();
+        }
+
+    private:
+        struct ColumnType {
+            std::size_t size = 0;
+            std::size_t align = 1;
+            void (*relocate)(void* destination, void* source) = nullptr; // ムーブ構築して元を破棄する
+            void (*destroy)(void* pointer) = nullptr;
+        };
+
+        struct Location {
+            std::uint32_t archetype;
+            std::uint32_t row;
+        };
+
+        struct alignas(CACHE_LINE_SIZE) Chunk {
+            std::byte data[ARCHETYPE_CHUNK_SIZE];
+        };
+
+        struct Archetype {
+            static constexpr std::size_t NO_COLUMN = ~std::size_t{0};
+
+            Signature signature;
+            std::vector<ComponentType> types;
+            std::array<std::size_t, MAX_COMPONENTS> columnOf;
+            std::vector<std::size_t> columnOffsets;
+            std::vector<std::size_t> columnSizes;
+            std::size_t capacity = 0;
+            std::size_t count = 0;
+            std::vector<std::unique_ptr<Chunk>> chunks;
+
+            Entity* entities(std::size_t chunk) {
+                return reinterpret_cast<Entity*>(chunks[chunk]->data);
+            }
+
+            void* column(std::size_t chunk, std::size_t column) {
+                return chunks[chunk]->data + columnOffsets[column];
+            }
+
+            void* at(std::size_t row, std::size_t column) {
+                return chunks[row / capacity]->data + columnOffsets[column] + (row % capacity) * columnSizes[column];
+            }
+
+            Entity& entityAt(std::size_t row) {
+                return entities(row / capacity)[row % capacity];
+            }
+        };
+
+        std::array<ColumnType, MAX_COMPONENTS> columnTypes{};
+        std::vector<std::unique_ptr<Archetype>> archetypes{};
+        std::unordered_map<Signature, std::uint32_t> archetypeIndices{};
+        PagedArray<Location> locations;
+
+        template<typename T>
+        static void place(Archetype& archetype, std::size_t row, ComponentType type, bool existed, T component) {
+            void* slot = archetype.at(row, archetype.columnOf[type]);
+            if (existed) {
+                *static_cast<T*>(slot) = std::move(component);
+            } else {
+                ::new (slot) T(std::move(component));
+            }
+        }
+
+        std::uint32_t findOrCreateArchetype(Signature signature) {
+            auto found = archetypeIndices.find(signature);
+            if (found != archetypeIndices.end()) {
+                return found->second;
+            }
+
+            auto archetype = std::make_unique<Archetype>();
+            archetype->signature = signature;
+            archetype->columnOf.fill(Archetype::NO_COLUMN);
+            std::size_t rowBytes = sizeof(Entity);
+            for (std::size_t type = 0; type < MAX_COMPONENTS; ++type) {
+                if (signature.test(type)) {
+                    if (columnTypes[type].size == 0) {
+                        throw std::runtime_error("Component not registered with archetype storage.");
+                    }
+                    archetype->columnOf[type] = archetype->types.size();
+                    archetype->types.push_back(static_cast<ComponentType>(type));
+                    archetype->columnSizes.push_back(columnTypes[type].size);
+                    rowBytes += columnTypes[type].size;
+                }
+            }
+
+            // 列ごとの境界揃えの余白を含めてチャンクに収まる最大の行数を選ぶ
+            std::size_t capacity = ARCHETYPE_CHUNK_SIZE / rowBytes;
+            for (; capacity > 0; --capacity) {
+                if (layoutColumns(*archetype, capacity) <= ARCHETYPE_CHUNK_SIZE) {
+                    break;
+                }
+            }
+            if (capacity == 0) {
+                throw std::runtime_error("Archetype row does not fit in a chunk.");
+            }
+            archetype->capacity = capacity;
+
+            auto index = static_cast<std::uint32_t>(archetypes.size());
+            archetypes.push_back(std::move(archetype));
+            archetypeIndices.emplace(signature, index);
+            return index;
+        }
+
+        // 列の開始位置を決め、使うバイト数を返す
+        std::size_t layoutColumns(Archetype& archetype, std::size_t capacity) const {
+            archetype.columnOffsets.clear();
+            std::size_t offset = sizeof(Entity) * capacity;
+            for (ComponentType type : archetype.types) {
+                std::size_t align = columnTypes[type].align;
+                offset = (offset + align - 1) / align * align;
+                archetype.columnOffsets.push_back(offset);
+                offset += columnTypes[type].size * capacity;
+            }
+            return offset;
+        }
+
+        std::size_t appendRow(Archetype& archetype, Entity entity) {
+            std::size_t row = archetype.count++;
+            if (row / archetype.capacity >= archetype.chunks.size()) {
+                archetype.chunks.push_back(std::make_unique<Chunk>());
+            }
+            archetype.entityAt(row) = entity;
+            return row;
+        }
+
+        // 空いた行に末尾の行を詰める（列の中身は呼び出し側で移動・破棄済み）
+        void removeRow(Archetype& archetype, std::size_t row) {
+            std::size_t last = --archetype.count;
+            if (row != last) {
+                for (std::size_t column = 0; column < archetype.types.size(); ++column) {
+                    columnTypes[archetype.types[column]].relocate(archetype.at(row, column), archetype.at(last, column));
+                }
+                Entity moved = archetype.entityAt(last);
+                archetype.entityAt(row) = moved;
+                locations[moved].row = static_cast<std::uint32_t>(row);
+            }
+            // 末尾の空きチャンクは一つだけ残して解放する
+            std::size_t usedChunks = (archetype.count + archetype.capacity - 1) / archetype.capacity;
+            if (archetype.chunks.size() > usedChunks + 1) {
+                archetype.chunks.pop_back();
+            }
+        }
+
+        // 共通の列は新しいアーキタイプへ移し、無くなる列は破棄する。新しく増える列は未構築のまま
+        void moveEntity(Entity entity, Signature newSignature) {
+            Location& location = locations.assure(entity);
+            Archetype* source = location.archetype != NO_ARCHETYPE ? archetypes[location.archetype].get() : nullptr;
+
+            Location newLocation{NO_ARCHETYPE, 0};
+            if (newSignature.any()) {
+                std::uint32_t targetIndex = findOrCreateArchetype(newSignature);
+                Archetype& target = *archetypes[targetIndex];
+                std::size_t row = appendRow(target, entity);
+                newLocation = Location{targetIndex, static_cast<std::uint32_t>(row)};
+                if (source) {
+                    for (std::size_t column = 0; column < source->types.size(); ++column) {
+                        ComponentType type = source->types[column];
+                        std::size_t targetColumn = target.columnOf[type];
+                        if (targetColumn != Archetype::NO_COLUMN) {
+                            columnTypes[type].relocate(target.at(row, targetColumn), source->at(location.row, column));
+                        } else {
+                            columnTypes[type].destroy(source->at(location.row, column));
+                        }
+                    }
+                }
+            } else if (source) {
+                for (std::size_t column = 0; column < source->types.size(); ++column) {
+                    columnTypes[source->types[column]].destroy(source->at(location.row, column));
+                }
+            }
+
+            if (source) {
+                removeRow(*source, location.row);
+            }
+            location = newLocation;
+        }
+    };
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Types.hpp"
+#include "TypeId.hpp"
+#include "ComponentManager.hpp"
+#include "EntityManager.hpp"
+#include "ArchetypeStorage.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+    // CommandBuffer::createEntity() が返す仮ハンドル。同じバッファの中でだけ有効
+    struct PendingEntity {
+        std::uint32_t index;
+    };
+
+    // 構造変更（生成・破棄・コンポーネントの追加と削除）を記録しておき、同期点でまとめて反映する
+    // 記録はどのスレッドからでもよい。反映は Coordinator::flushCommands() で行う
+    // 同じ型に対する追加と削除が同じバッファにあれば、追加を先に反映する
+    class CommandBuffer {
+    public:
+        PendingEntity createEntity() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return PendingEntity{pendingEntityCount++};
+        }
+
+        void destroyEntity(Entity entity) {
+            std::lock_guard<std::mutex> lock(mutex);
+            destroyedEntities.push_back(entity);
+        }
+
+        template<typename T>
+        void addComponent(Entity entity, T component) {
+            std::lock_guard<std::mutex> lock(mutex);
+            assure<T>().adds.push_back({Target{entity, false}, std::move(component)});
+        }
+
+        template<typename T>
+        void addComponent(PendingEntity entity, T component) {
+            std::lock_guard<std::mutex> lock(mutex);
+            assure<T>().adds.push_back({Target{entity.index, true}, std::move(component)});
+        }
+
+        template<typename T>
+        void removeComponent(Entity entity) {
+            std::lock_guard<std::mutex> lock(mutex);
+            assure<T>().removes.push_back(entity);
+        }
+
+        bool empty() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pendingEntityCount == 0 && destroyedEntities.empty() && usedTypes.empty();
+        }
+
+    private:
+        friend class Coordinator;
+
+        struct Target {
+            Entity entity; // pending が true のときは PendingEntity::index
+            bool pending;
+        };
+
+        class IPendingComponents {
+        public:
+            virtual ~IPendingComponents() = default;
+
+            // 追加と削除を配列へまとめて反映し、シグネチャが変わったエンティティを touched に積む
+            // archetypes が指定されていればそちらへ反映する
+            virtual void apply(ComponentManager& componentManager, EntityManager& entityManager,
+                               ArchetypeStorage* archetypes, const std::vector<Entity>& created, const std::vector<Entity>& destroyed,
+                               std::vector<Entity>& touched, Signature& changedTypes) = 0;
+        };
+
+        template<typename T>
+        class PendingComponents : public IPendingComponents {
+        public:
+            std::vector<std::pair<Target, T>> adds;
+            std::vector<Entity> removes;
+
+            void apply(ComponentManager& componentManager, EntityManager& entityManager,
+                       ArchetypeStorage* archetypes, const std::vector<Entity>& created, const std::vector<Entity>& destroyed,
+                       std::vector<Entity>& touched, Signature& changedTypes) override {
+                auto* array = componentManager.getComponentArray<T>();
+                ComponentType type = componentManager.getComponentType<T>();
+
+                // 同じバッファで破棄されるもの、記録後に別の経路で破棄されたものには反映しない
+                auto isDestroyed = [&](Entity entity) {
+                    return !entityManager.isAlive(entity) ||
+                           std::binary_search(destroyed.begin(), destroyed.end(), entity);
+                };
+
+                // 同じエンティティへの追加は後勝ち。エンティティ順に並べて配列へ詰める
+                for (auto& add : adds) {
+                    if (add.first.pending) {
+                        add.first.entity = created[add.first.entity];
+                    }
+                }
+                std::stable_sort(adds.begin(), adds.end(), [](const auto& a, const auto& b) {
+                    return a.first.entity < b.first.entity;
+                });
+                if (!archetypes) {
+                    array->reserve(array->size() + adds.size());
+                }
+                for (auto& add : adds) {
+                    Entity entity = add.first.entity;
+                    if (isDestroyed(entity)) {
+                        continue;
+                    }
+                    if (archetypes) {
+                        archetypes->insert<T>(entity, {type}, std::move(add.second));
+                    } else {
+                        array->insertData(entity, std::move(add.second));
+                    }
+                    setBit(entityManager, entity, type, true, touched);
+                }
+
+                std::sort(removes.begin(), removes.end());
+                removes.erase(std::unique(removes.begin(), removes.end()), removes.end());
+                for (Entity entity : removes) {
+                    bool present = archetypes ? archetypes->has(entity, type) : array->hasData(entity);
+                    if (isDestroyed(entity) || !present) {
+                        continue;
+                    }
+                    if (archetypes) {
+                        archetypes->remove(entity, type);
+                    } else {
+                        array->removeData(entity);
+                    }
+                    setBit(entityManager, entity, type, false, touched);
+                }
+
+                if (!adds.empty() || !removes.empty()) {
+                    changedTypes.set(type, true);
+                }
+                adds.clear();
+                removes.clear();
+            }
+
+        private:
+            static void setBit(EntityManager& entityManager, Entity entity, ComponentType type, bool value,
+                               std::vector<Entity>& touched) {
+                auto signature = entityManager.getSignature(entity);
+                signature.set(type, value);
+                entityManager.setSignature(entity, signature);
+                touched.push_back(entity);
+            }
+        };
+
+        std::mutex mutex;
+        std::uint32_t pendingEntityCount{};
+        std::vector<Entity> destroyedEntities{};
+        // 添字は typeId<ComponentFamily, T>。一度確保したバッファは使い回す
+        std::vector<std::unique_ptr<IPendingComponents>> pendingComponents{};
+        std::vector<std::size_t> usedTypes{};
+
+        template<typename T>
+        PendingComponents<T>& assure() {
+            std::size_t id = typeId<ComponentFamily, T>;
+            if (id >= pendingComponents.size()) {
+                pendingComponents.resize(id + 1);
+            }
+            if (!pendingComponents[id]) {
+                pendingComponents[id] = std::make_unique<PendingComponents<T>>();
+            }
+            if (std::find(usedTypes.begin(), usedTypes.end(), id) == usedTypes.end()) {
+                usedTypes.push_back(id);
+            }
+            return static_cast<PendingComponents<T>&>(*pendingComponents[id]);
+        }
+    };
+}
@@ -2,11 +2,13 @@
 #pragma once
 
 #include "Types.hpp"
-#include <any>
+#include "SparseSet.hpp"
+#include "ComponentStorage.hpp"
+#include "TypeId.hpp"
+#include <atomic>
 #include <memory>
-#include <unordered_map>
-#include <typeindex>
-#include <array>
+#include <span>
+#include <vector>
 #include <stdexcept>
 
 namespace ECS {
@@ -14,85 +16,252 @@ namespace ECS {
     public:
         virtual ~IComponentArray() = default;
         virtual void entityDestroyed(Entity entity) = 0;
+        virtual void entitiesDestroyed(std::span<const Entity> entities) = 0;
         virtual bool hasData(Entity entity) const = 0;
+        // 密配列上の2つの位置を入れ替える（型を知らずに並べ替えるため）
+        virtual void swapAt(std::size_t a, std::size_t b) = 0;
+
+        // 所持エンティティの疎集合（ビューの走査と除外判定に使う）
+        const SparseSet& getEntitySet() const {
+            return entitySet;
+        }
+
+        // 変更の追跡。追加・削除・並べ替えは自動で記録し、値の書き換えは書いた側が markChanged で知らせる
+        // 時刻は ComponentManager の時計から読む（時計が無ければ常に 0）
+        void setChangeClock(const std::atomic<ChangeTick>* clock) {
+            changeClock = clock;
+        }
+
+        void markChanged(Entity entity) {
+            markChangedAt(entitySet.index(entity));
+        }
+
+        // 別々のインデックスであれば複数のスレッドから同時に呼んでよい
+        void markChangedAt(std::size_t index) {
+            ChangeTick now = currentTick();
+            changeTicks[index] = now;
+            raise(lastChangeTick, now);
+        }
+
+        // 全要素を書き換えたときに O(1) で記録する
+        void markAllChanged() {
+            ChangeTick now = currentTick();
+            raise(allChangedTick, now);
+            raise(lastChangeTick, now);
+        }
+
+        bool changedSince(Entity entity, ChangeTick since) const {
+            return changedSinceAt(entitySet.index(entity), since);
+        }
+
+        bool changedSinceAt(std::size_t index, ChangeTick since) const {
+            return changeTicks[index] > since || allChangedTick.load(std::memory_order_relaxed) > since;
+        }
+
+        // 値か構造のどちらかが since より後に変わったか
+        bool anyChangedSince(ChangeTick since) const {
+            return lastChangeTick.load(std::memory_order_relaxed) > since;
+        }
+
+        // 追加・削除・並べ替えで密配列の並びが since より後に変わったか
+        bool structureChangedSince(ChangeTick since) const {
+            return structureChangeTick.load(std::memory_order_relaxed) > since;
+        }
+
+    protected:
+        SparseSet entitySet{};
+        // 密配列と同じ並びで、各要素を最後に書き換えた時刻
+        std::vector<ChangeTick> changeTicks{};
+
+        void trackInsert(std::size_t index) {
+            ChangeTick now = currentTick();
+            if (index == changeTicks.size()) {
+                changeTicks.push_back(now);
+                raise(structureChangeTick, now);
+            } else {
+                changeTicks[index] = now;
+            }
+            raise(lastChangeTick, now);
+        }
+
+        void trackRemove(std::size_t index) {
+            changeTicks[index] = changeTicks.back();
+            changeTicks.pop_back();
+            touchStructure();
+        }
+
+        void trackSwap(std::size_t a, std::size_t b) {
+            std::swap(changeTicks[a], changeTicks[b]);
+            touchStructure();
+        }
+
+    private:
+        const std::atomic<ChangeTick>* changeClock = nullptr;
+        std::atomic<ChangeTick> lastChangeTick{0};
+        std::atomic<ChangeTick> allChangedTick{0};
+        std::atomic<ChangeTick> structureChangeTick{0};
+
+        ChangeTick currentTick() const {
+            return changeClock ? changeClock->load(std::memory_order_relaxed) : 0;
+        }
+
+        void touchStructure() {
+            ChangeTick now = currentTick();
+            raise(structureChangeTick, now);
+            raise(lastChangeTick, now);
+        }
+
+        static void raise(std::atomic<ChangeTick>& tick, ChangeTick value) {
+            ChangeTick current = tick.load(std::memory_order_relaxed);
+            while (current < value && !tick.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+            }
+        }
     };
 
+    // 格納方法は ComponentLayout<T>::Storage で決まる（既定は AoS）
     template<typename T>
     class ComponentArray : public IComponentArray {
     public:
+        using Storage = typename ComponentLayout<T>::Storage;
+        using Reference = typename Storage::Reference;
+        using ConstReference = typename Storage::ConstReference;
+        using Streams = typename Storage::Streams;
+
         void insertData(Entity entity, T component) {
-            entityToIndexMap[entity] = size;
-            indexToEntityMap[size] = entity;
-            componentArray[size] = component;
-            ++size;
+            std::size_t index = entitySet.insert(entity);
+            if (index == storage.size()) {
+                storage.push_back(std::move(component));
+            } else {
+                storage.set(index, std::move(component));
+            }
+            trackInsert(index);
+        }
+
+        // まとめて追加する。容量の確保は一度だけ
+        void insertData(std::span<const Entity> entities, std::span<const T> components) {
+            reserve(storage.size() + entities.size());
+            for (std::size_t i = 0; i < entities.size(); ++i) {
+                insertData(entities[i], components[i]);
+            }
         }
 
         void removeData(Entity entity) {
-            size_t indexOfRemovedEntity = entityToIndexMap[entity];
-            size_t indexOfLastElement = size - 1;
-            componentArray[indexOfRemovedEntity] = componentArray[indexOfLastElement];
+            // 末尾要素を削除位置へ移動し、疎集合側も同じ入れ替えを行う
+            std::size_t indexOfRemovedEntity = entitySet.index(entity);
+            std::size_t indexOfLastElement = storage.size() - 1;
+            if (indexOfRemovedEntity != indexOfLastElement) {
+                storage.moveToFrom(indexOfRemovedEntity, indexOfLastElement);
+            }
+            storage.pop_back();
+            trackRemove(indexOfRemovedEntity);
+            entitySet.erase(entity);
+        }
+
+        Reference getData(Entity entity) {
+            return storage.at(entitySet.index(entity));
+        }
 
-            Entity lastEntity = indexToEntityMap[indexOfLastElement];
-            entityToIndexMap[lastEntity] = indexOfRemovedEntity;
-            indexToEntityMap[indexOfRemovedEntity] = lastEntity;
+        ConstReference getData(Entity entity) const {
+            return storage.at(entitySet.index(entity));
+        }
 
-            entityToIndexMap.erase(entity);
-            indexToEntityMap.erase(indexOfLastElement);
+        // 密配列上のインデックスで引く（getEntitySet() と同じ並び）
+        Reference getDataAt(std::size_t index) {
+            return storage.at(index);
+        }
 
-            --size;
+        // 密配列上の2つの位置を入れ替える（ビューの並び揃えや並べ替えに使う）
+        void swapAt(std::size_t a, std::size_t b) override {
+            entitySet.swapAt(a, b);
+            storage.swap(a, b);
+            trackSwap(a, b);
         }
 
-        T& getData(Entity entity) {
-            return componentArray[entityToIndexMap[entity]];
+        // 密配列の生データ。AoS なら T*、SoA なら成分ごとのポインタ
+        Streams streams() {
+            return storage.streams();
         }
 
         bool hasData(Entity entity) const override {
-            return entityToIndexMap.find(entity) != entityToIndexMap.end();
+            return entitySet.contains(entity);
         }
 
         void entityDestroyed(Entity entity) override {
-            if (entityToIndexMap.find(entity) != entityToIndexMap.end()) {
+            if (entitySet.contains(entity)) {
                 removeData(entity);
             }
         }
 
+        void entitiesDestroyed(std::span<const Entity> entities) override {
+            if (entitySet.empty()) {
+                return;
+            }
+            for (Entity entity : entities) {
+                if (entitySet.contains(entity)) {
+                    removeData(entity);
+                }
+            }
+        }
+
+        // 容量は生存データに合わせて伸びる。大量生成の前に呼ぶと再確保を避けられる
+        void reserve(std::size_t capacity) {
+            storage.reserve(capacity);
+            entitySet.reserve(capacity);
+            changeTicks.reserve(capacity);
+        }
+
+        std::size_t size() const { return storage.size(); }
+
     private:
-        std::array<T, MAX_ENTITIES> componentArray{};
-        std::unordered_map<Entity, size_t> entityToIndexMap{};
-        std::unordered_map<size_t, Entity> indexToEntityMap{};
-        size_t size{};
+        Storage storage{};
     };
 
+    // ビューやシステムがコンポーネントを受け取る型（AoS なら T&、SoA ならプロキシ）
+    template<typename T>
+    using ComponentRef = typename ComponentArray<T>::Reference;
+
     class ComponentManager {
     public:
         template<typename T>
         void registerComponent() {
-            const char* typeName = typeid(T).name();
+            std::size_t id = typeId<ComponentFamily, T>;
 
-            if (componentTypes.find(typeName) != componentTypes.end()) {
+            if (id < componentArrays.size() && componentArrays[id]) {
                 throw std::runtime_error("Registering component type more than once.");
             }
+            if (nextComponentType >= MAX_COMPONENTS) {
+                throw std::runtime_error("Too many component types registered.");
+            }
 
-            componentTypes.insert({typeName, nextComponentType});
-            componentArrays.insert({typeName, std::make_shared<ComponentArray<T>>()});
+            if (id >= componentArrays.size()) {
+                componentArrays.resize(id + 1);
+                componentTypes.resize(id + 1);
+            }
+            componentArrays[id] = std::make_unique<ComponentArray<T>>();
+            componentArrays[id]->setChangeClock(&changeClock);
+            componentTypes[id] = nextComponentType;
 
             ++nextComponentType;
         }
 
         template<typename T>
         ComponentType getComponentType() {
-            const char* typeName = typeid(T).name();
+            return componentTypes[checkedTypeId<T>()];
+        }
 
-            if (componentTypes.find(typeName) == componentTypes.end()) {
-                throw std::runtime_error("Component not registered before use.");
-            }
+        template<typename T>
+        void addComponent(Entity entity, T component) {
+            getComponentArray<T>()->insertData(entity, std::move(component));
+        }
 
-            return componentTypes[typeName];
+        template<typename T>
+        void addComponents(std::span<const Entity> entities, std::span<const T> components) {
+            getComponentArray<T>()->insertData(entities, components);
         }
 
         template<typename T>
-        void addComponent(Entity entity, T component) {
-            getComponentArray<T>()->insertData(entity, component);
+        void reserveComponent(std::size_t count) {
+            getComponentArray<T>()->reserve(count);
         }
 
         template<typename T>
@@ -101,7 +270,7 @@ namespace ECS {
         }
 
         template<typename T>
-        T& getComponent(Entity entity) {
+        ComponentRef<T> getComponent(Entity entity) {
             return getComponentArray<T>()->getData(entity);
         }
 
@@ -111,26 +280,52 @@ namespace ECS {
         }
 
         void entityDestroyed(Entity entity) {
-            for (auto const& pair : componentArrays) {
-                auto const& component = pair.second;
-                component->entityDestroyed(entity);
+            for (auto const& component : componentArrays) {
+                if (component) {
+                    component->entityDestroyed(entity);
+                }
+            }
+        }
+
+        // 配列ごとにまとめて削除する
+        void entitiesDestroyed(std::span<const Entity> entities) {
+            for (auto const& component : componentArrays) {
+                if (component) {
+                    component->entitiesDestroyed(entities);
+                }
             }
         }
 
+        ChangeTick getChangeTick() const {
+            return changeClock.load(std::memory_order_relaxed);
+        }
+
+        // 現在の時刻を返して時計を進める。以降の書き込みは返した時刻より後として記録される
+        ChangeTick advanceChangeTick() {
+            return changeClock.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 型 ID で直接引く。shared_ptr のコピーもハッシュ計算も発生しない
+        template<typename T>
+        ComponentArray<T>* getComponentArray() {
+            return static_cast<ComponentArray<T>*>(componentArrays[checkedTypeId<T>()].get());
+        }
+
     private:
-        std::unordered_map<const char*, ComponentType> componentTypes{};
-        std::unordered_map<const char*, std::shared_ptr<IComponentArray>> componentArrays{};
+        // 添字は typeId<ComponentFamily, T>
+        std::vector<std::unique_ptr<IComponentArray>> componentArrays{};
+        std::vector<ComponentType> componentTypes{};
         ComponentType nextComponentType{};
+        // 0 は「一度も変更されていない」を表すので 1 から始める
+        std::atomic<ChangeTick> changeClock{1};
 
         template<typename T>
-        std::shared_ptr<ComponentArray<T>> getComponentArray() {
-            const char* typeName = typeid(T).name();
-
-            if (componentTypes.find(typeName) == componentTypes.end()) {
+        std::size_t checkedTypeId() const {
+            std::size_t id = typeId<ComponentFamily, T>;
+            if (id >= componentArrays.size() || !componentArrays[id]) {
                 throw std::runtime_error("Component not registered before use.");
             }
-
-            return std::static_pointer_cast<ComponentArray<T>>(componentArrays[typeName]);
+            return id;
         }
     };
 }
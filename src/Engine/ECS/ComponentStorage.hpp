@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+    constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    // 先頭をキャッシュライン境界に揃えて確保するアロケータ
+    template<typename T, std::size_t Alignment = CACHE_LINE_SIZE>
+    class AlignedAllocator {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(std::size_t count) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        void deallocate(T* pointer, std::size_t) noexcept {
+            ::operator delete(pointer, std::align_val_t{Alignment});
+        }
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+            return true;
+        }
+    };
+
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    // 既定の配置：コンポーネントをそのまま連続して並べる（AoS）
+    template<typename T>
+    class AoSStorage {
+    public:
+        using Reference = T&;
+        using ConstReference = const T&;
+        using Streams = T*;
+
+        void push_back(T component) { components.push_back(std::move(component)); }
+        void set(std::size_t index, T component) { components[index] = std::move(component); }
+        void moveToFrom(std::size_t to, std::size_t from) { components[to] = std::move(components[from]); }
+        void pop_back() { components.pop_back(); }
+        void swap(std::size_t a, std::size_t b) { std::swap(components[a], components[b]); }
+        void reserve(std::size_t capacity) { components.reserve(capacity); }
+        std::size_t size() const { return components.size(); }
+
+        // 別の場所（アーキタイプのチャンクなど）にある T を同じ参照型で渡すため
+        static Reference makeReference(T& component) { return component; }
+
+        Reference at(std::size_t index) { return components[index]; }
+        ConstReference at(std::size_t index) const { return components[index]; }
+        Streams streams() { return components.data(); }
+
+    private:
+        std::vector<T> components{};
+    };
+
+    // 3つの float ストリームの1要素をまとめて指す参照（Vec は x, y, z を持つベクトル型）
+    template<typename Vec>
+    struct Float3Ref {
+        float& x;
+        float& y;
+        float& z;
+
+        Vec value() const { return Vec(x, y, z); }
+        operator Vec() const { return value(); }
+
+        Float3Ref& operator=(const Vec& v) {
+            x = v.x;
+            y = v.y;
+            z = v.z;
+            return *this;
+        }
+        Float3Ref& operator=(const Float3Ref& other) { return *this = other.value(); }
+        Float3Ref& operator+=(const Vec& v) { return *this = value() + v; }
+        Float3Ref& operator-=(const Vec& v) { return *this = value() - v; }
+        Float3Ref& operator*=(float s) { return *this = value() * s; }
+    };
+
+    struct Float3Streams {
+        float* x;
+        float* y;
+        float* z;
+    };
+
+    // SoA 配置：Member が指す3成分ベクトルを x[], y[], z[] の別々の整列済み配列に持つ
+    // 要素の参照は Ref（Float3Ref<Vec> から構築できるプロキシ）として返す
+    template<typename T, auto Member, typename Ref>
+    class Float3SoAStorage {
+    public:
+        using Reference = Ref;
+        using ConstReference = T;
+        using Streams = Float3Streams;
+
+        void push_back(const T& component) {
+            const auto& v = component.*Member;
+            xs.push_back(v.x);
+            ys.push_back(v.y);
+            zs.push_back(v.z);
+        }
+        void set(std::size_t index, const T& component) {
+            const auto& v = component.*Member;
+            xs[index] = v.x;
+            ys[index] = v.y;
+            zs[index] = v.z;
+        }
+        void moveToFrom(std::size_t to, std::size_t from) {
+            xs[to] = xs[from];
+            ys[to] = ys[from];
+            zs[to] = zs[from];
+        }
+        void pop_back() {
+            xs.pop_back();
+            ys.pop_back();
+            zs.pop_back();
+        }
+        void swap(std::size_t a, std::size_t b) {
+            std::swap(xs[a], xs[b]);
+            std::swap(ys[a], ys[b]);
+            std::swap(zs[a], zs[b]);
+        }
+        void reserve(std::size_t capacity) {
+            xs.reserve(capacity);
+            ys.reserve(capacity);
+            zs.reserve(capacity);
+        }
+        std::size_t size() const { return xs.size(); }
+
+        static Reference makeReference(T& component) {
+            auto& v = component.*Member;
+            return Ref{Float3Ref<Vec>{v.x, v.y, v.z}};
+        }
+
+        Reference at(std::size_t index) {
+            return Ref{Float3Ref<Vec>{xs[index], ys[index], zs[index]}};
+        }
+        ConstReference at(std::size_t index) const {
+            T component{};
+            component.*Member = Vec(xs[index], ys[index], zs[index]);
+            return component;
+        }
+        Streams streams() { return Float3Streams{xs.data(), ys.data(), zs.data()}; }
+
+    private:
+        using Vec = std::remove_cvref_t<decltype(std::declval<T&>().*Member)>;
+
+        AlignedVector<float> xs{};
+        AlignedVector<float> ys{};
+        AlignedVector<float> zs{};
+    };
+
+    // コンポーネントごとの格納方法。既定は AoS で、getComponent やビューは T& を返す
+    // SoA にしたい型はこのテンプレートを特殊化して Storage を差し替える（その型の参照はプロキシになる）
+    template<typename T>
+    struct ComponentLayout {
+        using Storage = AoSStorage<T>;
+    };
+}
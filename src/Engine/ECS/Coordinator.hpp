@@ -4,14 +4,33 @@
 #include "EntityManager.hpp"
 #include "ComponentManager.hpp"
 #include "SystemManager.hpp"
+#include "View.hpp"
+#include "ArchetypeStorage.hpp"
+#include "Query.hpp"
+#include "Reorder.hpp"
+#include "CommandBuffer.hpp"
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace ECS {
     class Coordinator {
     public:
-        void init() {
-            entityManager = std::make_unique<EntityManager>();
+        // maxEntities は生存エンティティ数の上限（既定では無制限）
+        // Archetype を選ぶとコンポーネントはチャンクに格納され、ビューの代わりに query() を使う
+        // ビュー（pack() と SoA ストリーム）・reorder()・要素ごとの変更追跡は疎集合方式にしか無いので、
+        // それらを使うシステム（移動・描画・空間整列）は Archetype では動かない
+        void init(Entity maxEntities = UNLIMITED_ENTITIES, StorageMode mode = StorageMode::SparseSet) {
+            entityManager = std::make_unique<EntityManager>(maxEntities);
             componentManager = std::make_unique<ComponentManager>();
             systemManager = std::make_unique<SystemManager>();
+            archetypeStorage = mode == StorageMode::Archetype ? std::make_unique<ArchetypeStorage>() : nullptr;
+        }
+
+        StorageMode getStorageMode() const {
+            return archetypeStorage ? StorageMode::Archetype : StorageMode::SparseSet;
         }
 
         // Entity methods
@@ -21,40 +40,159 @@ namespace ECS {
 
         void destroyEntity(Entity entity) {
             entityManager->destroyEntity(entity);
-            componentManager->entityDestroyed(entity);
+            if (archetypeStorage) {
+                archetypeStorage->destroy(entity);
+            } else {
+                componentManager->entityDestroyed(entity);
+            }
             systemManager->entityDestroyed(entity);
         }
 
+        // 大量生成。ID の発行とシグネチャ領域の確保を一度にまとめる
+        std::vector<Entity> createEntities(std::size_t count) {
+            std::vector<Entity> entities(count);
+            entityManager->createEntities(entities);
+            return entities;
+        }
+
+        // 大量破棄。コンポーネント配列ごと・システムごとにまとめて処理する
+        void destroyEntities(std::span<const Entity> entities) {
+            if (archetypeStorage) {
+                for (Entity entity : entities) {
+                    archetypeStorage->destroy(entity);
+                }
+            } else {
+                componentManager->entitiesDestroyed(entities);
+            }
+            systemManager->entitiesDestroyed(entities);
+            for (Entity entity : entities) {
+                entityManager->destroyEntity(entity);
+            }
+        }
+
+        // 世代付きハンドル。保持しておき、使う前に isAlive() か resolve() で確かめる
+        EntityHandle getHandle(Entity entity) const {
+            return entityManager->getHandle(entity);
+        }
+
+        bool isAlive(Entity entity) const {
+            return entityManager->isAlive(entity);
+        }
+
+        bool isAlive(EntityHandle handle) const {
+            return entityManager->isAlive(handle);
+        }
+
+        // 破棄済み（再利用されたスロットを含む）のハンドルなら例外を投げる
+        Entity resolve(EntityHandle handle) const {
+            if (!entityManager->isAlive(handle)) {
+                throw std::runtime_error("Stale entity handle.");
+            }
+            return handle.index;
+        }
+
+        void setMaxEntities(Entity count) {
+            entityManager->setMaxEntities(count);
+        }
+
+        void reserveEntities(Entity count) {
+            entityManager->reserve(count);
+        }
+
+        // これまでに発行したエンティティ ID の範囲 [0, getEntityRange())
+        Entity getEntityRange() const {
+            return entityManager->getEntityRange();
+        }
+
+        std::uint32_t getLivingEntityCount() const {
+            return entityManager->getLivingEntityCount();
+        }
+
         // Component methods
         template<typename T>
         void registerComponent() {
             componentManager->registerComponent<T>();
+            if (archetypeStorage) {
+                archetypeStorage->registerComponent<T>(componentManager->getComponentType<T>());
+            }
+        }
+
+        // アーキタイプ方式ではチャンク単位で確保するので何もしない
+        template<typename T>
+        void reserveComponent(std::size_t count) {
+            if (!archetypeStorage) {
+                componentManager->reserveComponent<T>(count);
+            }
         }
 
         template<typename T>
         void addComponent(Entity entity, T component) {
-            componentManager->addComponent<T>(entity, component);
+            if (archetypeStorage) {
+                archetypeStorage->insert<T>(entity, {componentManager->getComponentType<T>()}, std::move(component));
+            } else {
+                componentManager->addComponent<T>(entity, std::move(component));
+            }
 
             auto signature = entityManager->getSignature(entity);
-            signature.set(componentManager->getComponentType<T>(), true);
+            ComponentType type = componentManager->getComponentType<T>();
+            signature.set(type, true);
             entityManager->setSignature(entity, signature);
 
-            systemManager->entitySignatureChanged(entity, signature);
+            systemManager->entitySignatureChanged(entity, signature, type);
+        }
+
+        // 同じ範囲のエンティティへ複数種類のコンポーネントをまとめて追加する
+        // シグネチャとシステムの所属は範囲全体に対して一度だけ更新する
+        // 例: coordinator.addComponents<PositionComponent, VelocityComponent>(entities, positions, velocities)
+        template<typename... Ts>
+        void addComponents(std::span<const Entity> entities, std::span<const Ts>... components) {
+            if (((components.size() != entities.size()) || ...)) {
+                throw std::runtime_error("Component span size does not match entity count.");
+            }
+
+            if (archetypeStorage) {
+                // エンティティごとに移動先のアーキタイプを一度で決める
+                std::array<ComponentType, sizeof...(Ts)> types{componentManager->getComponentType<Ts>()...};
+                for (std::size_t i = 0; i < entities.size(); ++i) {
+                    archetypeStorage->insert<Ts...>(entities[i], types, components[i]...);
+                }
+            } else {
+                (componentManager->addComponents<Ts>(entities, components), ...);
+            }
+
+            Signature added;
+            (added.set(componentManager->getComponentType<Ts>(), true), ...);
+
+            signatureScratch.resize(entities.size());
+            for (std::size_t i = 0; i < entities.size(); ++i) {
+                signatureScratch[i] = entityManager->getSignature(entities[i]) | added;
+                entityManager->setSignature(entities[i], signatureScratch[i]);
+            }
+            systemManager->entitiesSignatureChanged(entities, signatureScratch, added);
         }
 
         template<typename T>
         void removeComponent(Entity entity) {
-            componentManager->removeComponent<T>(entity);
+            if (archetypeStorage) {
+                archetypeStorage->remove(entity, componentManager->getComponentType<T>());
+            } else {
+                componentManager->removeComponent<T>(entity);
+            }
 
             auto signature = entityManager->getSignature(entity);
-            signature.set(componentManager->getComponentType<T>(), false);
+            ComponentType type = componentManager->getComponentType<T>();
+            signature.set(type, false);
             entityManager->setSignature(entity, signature);
 
-            systemManager->entitySignatureChanged(entity, signature);
+            systemManager->entitySignatureChanged(entity, signature, type);
         }
 
         template<typename T>
-        T& getComponent(Entity entity) {
+        ComponentRef<T> getComponent(Entity entity) {
+            if (archetypeStorage) {
+                return ComponentArray<T>::Storage::makeReference(
+                    archetypeStorage->get<T>(entity, componentManager->getComponentType<T>()));
+            }
             return componentManager->getComponent<T>(entity);
         }
 
@@ -65,9 +203,130 @@ namespace ECS {
 
         template<typename T>
         bool hasComponent(Entity entity) {
+            if (archetypeStorage) {
+                return archetypeStorage->has(entity, componentManager->getComponentType<T>());
+            }
             return componentManager->hasComponent<T>(entity);
         }
 
+        // 複数コンポーネントを持つエンティティを最小の密配列から走査する（疎集合方式のみ）
+        // 例: coordinator.view<PositionComponent, VelocityComponent>().exclude<MorphingComponent>().each(...)
+        template<typename... Ts>
+        View<TypeList<Ts...>> view() {
+            if (archetypeStorage) {
+                throw std::runtime_error("Views require sparse-set storage; use query() instead.");
+            }
+            return View<TypeList<Ts...>>(*componentManager);
+        }
+
+        // どちらの格納方式でも使える走査
+        // 例: coordinator.query<MorphingComponent, PositionComponent>().each(...)
+        template<typename... Ts>
+        Query<Ts...> query() {
+            return Query<Ts...>(*componentManager, archetypeStorage.get());
+        }
+
+        // Ts の密配列を order の順に少しずつ並べ替える（疎集合方式のみ）
+        // 例: auto reorder = coordinator.reorder<PositionComponent, VelocityComponent>(order); reorder.step(budget);
+        template<typename... Ts>
+        Reorder reorder(std::vector<Entity> order) {
+            if (archetypeStorage) {
+                throw std::runtime_error("Reordering requires sparse-set storage.");
+            }
+            return Reorder(std::move(order), {componentManager->getComponentArray<Ts>()...});
+        }
+
+        // Change tracking
+        // 読む側は前回 advanceChangeTick() が返した時刻を覚えておき、それより後の変更だけを処理する
+        // 例: since = lastTick; lastTick = coordinator.advanceChangeTick(); if (coordinator.anyChangedSince<T>(since)) ...
+        ChangeTick advanceChangeTick() {
+            return componentManager->advanceChangeTick();
+        }
+
+        ChangeTick getChangeTick() const {
+            return componentManager->getChangeTick();
+        }
+
+        // アーキタイプ方式では追跡しないので、問い合わせは常に「変更あり」を返す
+        // 値を書き換えたら呼ぶ（追加・削除は自動で記録される）
+        template<typename T>
+        void markChanged(Entity entity) {
+            if (!archetypeStorage) {
+                componentManager->getComponentArray<T>()->markChanged(entity);
+            }
+        }
+
+        template<typename T>
+        void markAllChanged() {
+            if (!archetypeStorage) {
+                componentManager->getComponentArray<T>()->markAllChanged();
+            }
+        }
+
+        template<typename T>
+        bool changedSince(Entity entity, ChangeTick since) {
+            return archetypeStorage || componentManager->getComponentArray<T>()->changedSince(entity, since);
+        }
+
+        template<typename T>
+        bool anyChangedSince(ChangeTick since) {
+            return archetypeStorage || componentManager->getComponentArray<T>()->anyChangedSince(since);
+        }
+
+        template<typename T>
+        bool structureChangedSince(ChangeTick since) {
+            return archetypeStorage || componentManager->getComponentArray<T>()->structureChangedSince(since);
+        }
+
+        // Deferred structural changes
+        // 走査中の構造変更はここへ記録し、同期点で flushCommands() を呼ぶ
+        CommandBuffer& commands() {
+            return commandBuffer;
+        }
+
+        void flushCommands() {
+            flushCommands(commandBuffer);
+        }
+
+        // 生成 -> コンポーネント型ごとの追加・削除 -> システムごとの所属更新 -> 破棄 の順に反映する
+        void flushCommands(CommandBuffer& buffer) {
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+
+            createdScratch.resize(buffer.pendingEntityCount);
+            for (auto& entity : createdScratch) {
+                entity = entityManager->createEntity();
+            }
+
+            // 記録後に別の経路で破棄されたエンティティは除く
+            auto& destroyed = buffer.destroyedEntities;
+            std::sort(destroyed.begin(), destroyed.end());
+            destroyed.erase(std::unique(destroyed.begin(), destroyed.end()), destroyed.end());
+            destroyed.erase(std::remove_if(destroyed.begin(), destroyed.end(),
+                                           [this](Entity entity) { return !entityManager->isAlive(entity); }),
+                            destroyed.end());
+
+            touchedScratch.clear();
+            Signature changedTypes;
+            for (std::size_t id : buffer.usedTypes) {
+                buffer.pendingComponents[id]->apply(*componentManager, *entityManager, archetypeStorage.get(),
+                                                    createdScratch, destroyed, touchedScratch, changedTypes);
+            }
+
+            std::sort(touchedScratch.begin(), touchedScratch.end());
+            touchedScratch.erase(std::unique(touchedScratch.begin(), touchedScratch.end()), touchedScratch.end());
+            signatureScratch.resize(touchedScratch.size());
+            for (std::size_t i = 0; i < touchedScratch.size(); ++i) {
+                signatureScratch[i] = entityManager->getSignature(touchedScratch[i]);
+            }
+            systemManager->entitiesSignatureChanged(touchedScratch, signatureScratch, changedTypes);
+
+            destroyEntities(destroyed);
+
+            buffer.pendingEntityCount = 0;
+            buffer.destroyedEntities.clear();
+            buffer.usedTypes.clear();
+        }
+
         // System methods
         template<typename T>
         std::shared_ptr<T> registerSystem() {
@@ -83,5 +342,12 @@ namespace ECS {
         std::unique_ptr<EntityManager> entityManager;
         std::unique_ptr<ComponentManager> componentManager;
         std::unique_ptr<SystemManager> systemManager;
+        // StorageMode::Archetype のときだけ作る
+        std::unique_ptr<ArchetypeStorage> archetypeStorage;
+        CommandBuffer commandBuffer;
+        // flushCommands() の作業領域（フレームごとの再確保を避ける）
+        std::vector<Entity> createdScratch;
+        std::vector<Entity> touchedScratch;
+        std::vector<Signature> signatureScratch;
     };
 }
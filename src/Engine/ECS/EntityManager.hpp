@@ -1,36 +1,86 @@
-
 #pragma once
 
 #include "Types.hpp"
+#include "PagedArray.hpp"
+#include <functional>
 #include <queue>
-#include <array>
+#include <span>
 #include <stdexcept>
+#include <vector>
 
 namespace ECS {
     class EntityManager {
     public:
-        EntityManager() {
-            for (Entity entity = 0; entity < MAX_ENTITIES; ++entity) {
-                availableEntities.push(entity);
-            }
-        }
+        explicit EntityManager(Entity maxEntities = UNLIMITED_ENTITIES) : maxEntities(maxEntities) {}
 
         Entity createEntity() {
-            if (livingEntityCount >= MAX_ENTITIES) {
+            if (livingEntityCount >= maxEntities) {
                 throw std::runtime_error("Too many entities in existence.");
             }
-            Entity id = availableEntities.front();
-            availableEntities.pop();
+
+            // 再利用できる ID があれば最も小さいものを使い、無ければ新しい ID を発行して必要なページだけ確保する
+            Entity id;
+            if (!availableEntities.empty()) {
+                id = availableEntities.top();
+                availableEntities.pop();
+            } else {
+                id = nextEntity++;
+                signatures.assure(id);
+            }
+            ++generations.assure(id);
             ++livingEntityCount;
             return id;
         }
 
+        // まとめて生成する。再利用できる ID を先に使い、残りは連番で発行する
+        void createEntities(std::span<Entity> out) {
+            if (out.size() > maxEntities - livingEntityCount) {
+                throw std::runtime_error("Too many entities in existence.");
+            }
+
+            std::size_t i = 0;
+            for (; i < out.size() && !availableEntities.empty(); ++i) {
+                out[i] = availableEntities.top();
+                availableEntities.pop();
+            }
+            if (i < out.size()) {
+                std::size_t newRange = static_cast<std::size_t>(nextEntity) + (out.size() - i);
+                signatures.reserve(newRange);
+                generations.reserve(newRange);
+                for (; i < out.size(); ++i) {
+                    out[i] = nextEntity++;
+                }
+            }
+            for (Entity entity : out) {
+                ++generations[entity];
+            }
+            livingEntityCount += static_cast<std::uint32_t>(out.size());
+        }
+
         void destroyEntity(Entity entity) {
+            if (!isAlive(entity)) {
+                throw std::runtime_error("Destroying an entity that is not alive.");
+            }
             signatures[entity].reset();
+            ++generations[entity];
             availableEntities.push(entity);
             --livingEntityCount;
         }
 
+        // 世代は生成と破棄のたびに 1 進むので、奇数なら生存中
+        bool isAlive(Entity entity) const {
+            return (generations.get(entity) & 1u) != 0;
+        }
+
+        bool isAlive(EntityHandle handle) const {
+            return handle.generation != 0 && generations.get(handle.index) == handle.generation;
+        }
+
+        // 生存中のエンティティに対してのみ呼ぶこと
+        EntityHandle getHandle(Entity entity) const {
+            return EntityHandle{entity, generations[entity]};
+        }
+
         void setSignature(Entity entity, Signature signature) {
             signatures[entity] = signature;
         }
@@ -39,9 +89,31 @@ namespace ECS {
             return signatures[entity];
         }
 
+        void setMaxEntities(Entity count) {
+            maxEntities = count;
+        }
+
+        // 大量生成の前にシグネチャのページを確保しておく
+        void reserve(Entity count) {
+            signatures.reserve(count);
+        }
+
+        // これまでに発行した ID の範囲 [0, getEntityRange())
+        Entity getEntityRange() const {
+            return nextEntity;
+        }
+
+        std::uint32_t getLivingEntityCount() const {
+            return livingEntityCount;
+        }
+
     private:
-        std::queue<Entity> availableEntities{};
-        std::array<Signature, MAX_ENTITIES> signatures{};
+        // 破棄された ID の最小ヒープ。小さい ID から再利用して、生存中の ID を低く詰まった範囲に保つ
+        std::priority_queue<Entity, std::vector<Entity>, std::greater<Entity>> availableEntities{};
+        PagedArray<Signature> signatures{};
+        PagedArray<std::uint32_t> generations{0};
+        Entity nextEntity{};
+        Entity maxEntities;
         std::uint32_t livingEntityCount{};
     };
 }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ECS {
+    // 必要になったページだけを確保する可変長配列
+    // 要素のアドレスはページが解放されるまで変わらない
+    template<typename T, std::size_t PageSize = 4096>
+    class PagedArray {
+    public:
+        static constexpr std::size_t PAGE_SIZE = PageSize;
+
+        explicit PagedArray(T fillValue = T{}) : fillValue(fillValue) {}
+
+        bool hasPage(std::size_t index) const {
+            std::size_t page = index / PageSize;
+            return page < pages.size() && pages[page];
+        }
+
+        // ページが無ければ確保してから要素を返す
+        T& assure(std::size_t index) {
+            std::size_t page = index / PageSize;
+            if (page >= pages.size()) {
+                pages.resize(page + 1);
+            }
+            if (!pages[page]) {
+                pages[page] = std::make_unique<Page>();
+                pages[page]->fill(fillValue);
+            }
+            return (*pages[page])[index % PageSize];
+        }
+
+        // 範囲 [0, count) のページを前もって確保する
+        void reserve(std::size_t count) {
+            for (std::size_t index = 0; index < count; index += PageSize) {
+                assure(index);
+            }
+            if (count > 0) {
+                assure(count - 1);
+            }
+        }
+
+        // hasPage() が true のインデックスに対してのみ呼ぶこと
+        T& operator[](std::size_t index) {
+            return (*pages[index / PageSize])[index % PageSize];
+        }
+
+        const T& operator[](std::size_t index) const {
+            return (*pages[index / PageSize])[index % PageSize];
+        }
+
+        // ページが無ければ既定値を返す
+        const T& get(std::size_t index) const {
+            return hasPage(index) ? (*this)[index] : fillValue;
+        }
+
+        std::size_t pageCount() const { return pages.size(); }
+
+    private:
+        using Page = std::array<T, PageSize>;
+
+        std::vector<std::unique_ptr<Page>> pages{};
+        T fillValue;
+    };
+}
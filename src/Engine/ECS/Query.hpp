@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Types.hpp"
+#include "ComponentManager.hpp"
+#include "ArchetypeStorage.hpp"
+#include "View.hpp"
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ECS {
+    // 格納方式に依存しない走査。疎集合方式ならビュー、アーキタイプ方式なら一致するチャンクを先頭から順に読む
+    // func には ComponentRef<Ts> が渡されるので、どちらの方式でも同じ関数を使える
+    template<typename... Ts>
+    class Query {
+        static_assert(sizeof...(Ts) > 0, "Query needs at least one component.");
+
+    public:
+        Query(ComponentManager& manager, ArchetypeStorage* archetypes)
+            : manager(&manager), archetypes(archetypes), types{manager.getComponentType<Ts>()...} {}
+
+        // func(Entity, ComponentRef<Ts>...) または func(ComponentRef<Ts>...)
+        template<typename Func>
+        void each(Func&& func) {
+            if (!archetypes) {
+                View<TypeList<Ts...>>(*manager).each(func);
+                return;
+            }
+
+            eachChunk([&func](std::size_t count, const Entity* entities, Ts*... columns) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    if constexpr (std::is_invocable_v<Func&, Entity, ComponentRef<Ts>...>) {
+                        func(entities[i], ComponentArray<Ts>::Storage::makeReference(columns[i])...);
+                    } else {
+                        func(ComponentArray<Ts>::Storage::makeReference(columns[i])...);
+                    }
+                }
+            });
+        }
+
+        // アーキタイプ方式専用。チャンクごとに func(count, entities, Ts*...) を呼ぶ
+        // 列はチャンク内で連続しているので、そのままループやカーネルに渡せる
+        template<typename Func>
+        void eachChunk(Func&& func) {
+            if (!archetypes) {
+                throw std::runtime_error("Query::eachChunk requires archetype storage.");
+            }
+
+            Signature required;
+            for (ComponentType type : types) {
+                required.set(type, true);
+            }
+            archetypes->eachChunk(required, Signature{}, types,
+                                  [&func](std::size_t count, const Entity* entities,
+                                          const std::array<void*, sizeof...(Ts)>& columns) {
+                                      invokeChunk(func, count, entities, columns, std::index_sequence_for<Ts...>{});
+                                  });
+        }
+
+    private:
+        ComponentManager* manager;
+        ArchetypeStorage* archetypes;
+        std::array<ComponentType, sizeof...(Ts)> types;
+
+        template<typename Func, std::size_t... Is>
+        static void invokeChunk(Func& func, std::size_t count, const Entity* entities,
+                                const std::array<void*, sizeof...(Ts)>& columns, std::index_sequence<Is...>) {
+            func(count, entities, static_cast<Ts*>(columns[Is])...);
+        }
+    };
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Types.hpp"
+#include "ComponentManager.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+    // 目標の並び（エンティティの列）に合わせて、複数のコンポーネント配列を少しずつ並べ替える
+    // 各配列は自分が持つエンティティだけを目標の順に先頭から詰めるので、配列どうしの相対順序は揃う
+    // 途中で追加・削除があっても壊れない（並びが少し崩れるだけ）。その場合は次の並べ替えで整う
+    class Reorder {
+    public:
+        Reorder() = default;
+
+        Reorder(std::vector<Entity> order, std::vector<IComponentArray*> arrays)
+            : order(std::move(order)), arrays(std::move(arrays)), cursors(this->arrays.size(), 0) {}
+
+        // 目標の並びのうち最大 budget 件を配置する。すべて配置し終えたら true
+        bool step(std::size_t budget) {
+            std::size_t end = std::min(order.size(), next + budget);
+            for (; next < end; ++next) {
+                Entity entity = order[next];
+                for (std::size_t i = 0; i < arrays.size(); ++i) {
+                    place(*arrays[i], cursors[i], entity);
+                }
+            }
+            return done();
+        }
+
+        bool done() const {
+            return next >= order.size();
+        }
+
+        // 配置済みの件数と全体の件数
+        std::size_t progress() const {
+            return next;
+        }
+
+        std::size_t size() const {
+            return order.size();
+        }
+
+    private:
+        std::vector<Entity> order{};
+        std::vector<IComponentArray*> arrays{};
+        // 配列ごとの、次に詰める密配列上の位置
+        std::vector<std::size_t> cursors{};
+        std::size_t next = 0;
+
+        static void place(IComponentArray& array, std::size_t& cursor, Entity entity) {
+            const SparseSet& set = array.getEntitySet();
+            if (!set.contains(entity)) {
+                return;
+            }
+            // 削除で配列が縮むと、配置済みの範囲に後ろの要素が入ってくることがある
+            std::size_t index = set.index(entity);
+            if (index < cursor || cursor >= set.size()) {
+                return;
+            }
+            if (index != cursor) {
+                array.swapAt(index, cursor);
+            }
+            ++cursor;
+        }
+    };
+}
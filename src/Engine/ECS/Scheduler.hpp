@@ -0,0 +1,169 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Coordinator.hpp"
+#include "../Jobs/ThreadPool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ECS {
+    // システムが読むコンポーネント・書くコンポーネントの宣言
+    template<typename... Ts>
+    struct Reads {};
+
+    template<typename... Ts>
+    struct Writes {};
+
+    enum class ThreadAffinity {
+        Any,        // ワーカースレッドで実行してよい
+        MainThread  // SDL のレンダラーなど、メインスレッドでしか触れないものを使う
+    };
+
+    // 読み書きの宣言から毎フレーム依存グラフを組み、衝突しないシステムを並列に実行する
+    // 登録順が優先順位で、衝突する組は先に登録した方が先に走る
+    // MainThread のシステム同士は登録順に直列で実行する
+    class Scheduler {
+    public:
+        using UpdateFunc = std::function<void(float)>;
+
+        Scheduler(Coordinator& coordinator, Jobs::ThreadPool& threadPool)
+            : coordinator(coordinator), threadPool(threadPool) {}
+
+        template<typename... R, typename... W>
+        void addSystem(std::string name, Reads<R...>, Writes<W...>, UpdateFunc update,
+                       ThreadAffinity affinity = ThreadAffinity::Any) {
+            Node node;
+            node.name = std::move(name);
+            node.update = std::move(update);
+            node.affinity = affinity;
+            (node.reads.set(coordinator.getComponentType<R>(), true), ...);
+            (node.writes.set(coordinator.getComponentType<W>(), true), ...);
+            nodes.push_back(std::move(node));
+        }
+
+        void setEnabled(const std::string& name, bool enabled) {
+            for (auto& node : nodes) {
+                if (node.name == name) {
+                    node.enabled = enabled;
+                }
+            }
+        }
+
+        // 1フレーム分を実行し、すべてのシステムが終わるまで戻らない
+        void run(float deltaTime) {
+            buildGraph();
+
+            Frame frame;
+            frame.deltaTime = deltaTime;
+            frame.remaining = activeCount;
+            frame.pendingDependencies = std::make_unique<std::atomic<int>[]>(nodes.size());
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                frame.pendingDependencies[i].store(dependencyCounts[i], std::memory_order_relaxed);
+            }
+
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+                if (nodes[i].enabled && dependencyCounts[i] == 0) {
+                    launch(frame, i);
+                }
+            }
+
+            // メインスレッド指定のシステムはここで実行しつつ全体の完了を待つ
+            std::unique_lock<std::mutex> lock(frame.mutex);
+            for (;;) {
+                frame.condition.wait(lock, [&frame]() { return frame.remaining == 0 || !frame.mainThreadReady.empty(); });
+                if (frame.mainThreadReady.empty()) {
+                    break;
+                }
+                std::size_t index = frame.mainThreadReady.front();
+                frame.mainThreadReady.erase(frame.mainThreadReady.begin());
+                lock.unlock();
+                execute(frame, index);
+                lock.lock();
+            }
+        }
+
+    private:
+        struct Node {
+            std::string name;
+            UpdateFunc update;
+            ThreadAffinity affinity = ThreadAffinity::Any;
+            Signature reads;
+            Signature writes;
+            bool enabled = true;
+        };
+
+        struct Frame {
+            float deltaTime = 0.0f;
+            std::unique_ptr<std::atomic<int>[]> pendingDependencies;
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<std::size_t> mainThreadReady;
+            std::size_t remaining = 0;
+        };
+
+        Coordinator& coordinator;
+        Jobs::ThreadPool& threadPool;
+        std::vector<Node> nodes;
+        // 毎フレーム組み直す依存グラフ（successors[i] は i の完了を待つシステム）
+        std::vector<std::vector<std::size_t>> successors;
+        std::vector<int> dependencyCounts;
+        std::size_t activeCount = 0;
+
+        static bool conflicts(const Node& a, const Node& b) {
+            if (a.affinity == ThreadAffinity::MainThread && b.affinity == ThreadAffinity::MainThread) {
+                return true;
+            }
+            return (a.writes & (b.reads | b.writes)).any() || (b.writes & a.reads).any();
+        }
+
+        void buildGraph() {
+            successors.assign(nodes.size(), {});
+            dependencyCounts.assign(nodes.size(), 0);
+            activeCount = 0;
+
+            for (std::size_t later = 0; later < nodes.size(); ++later) {
+                if (!nodes[later].enabled) {
+                    continue;
+                }
+                ++activeCount;
+                for (std::size_t earlier = 0; earlier < later; ++earlier) {
+                    if (nodes[earlier].enabled && conflicts(nodes[earlier], nodes[later])) {
+                        successors[earlier].push_back(later);
+                        ++dependencyCounts[later];
+                    }
+                }
+            }
+        }
+
+        void launch(Frame& frame, std::size_t index) {
+            if (nodes[index].affinity == ThreadAffinity::MainThread) {
+                std::lock_guard<std::mutex> lock(frame.mutex);
+                frame.mainThreadReady.push_back(index);
+                frame.condition.notify_all();
+            } else {
+                threadPool.submit([this, &frame, index]() { execute(frame, index); });
+            }
+        }
+
+        void execute(Frame& frame, std::size_t index) {
+            nodes[index].update(frame.deltaTime);
+
+            for (std::size_t next : successors[index]) {
+                if (frame.pendingDependencies[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    launch(frame, next);
+                }
+            }
+
+            // ロックを持ったまま通知する。run() はこの後すぐに frame を破棄しうる
+            std::lock_guard<std::mutex> lock(frame.mutex);
+            --frame.remaining;
+            frame.condition.notify_all();
+        }
+    };
+}
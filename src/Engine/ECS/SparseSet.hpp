@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Types.hpp"
+#include "PagedArray.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ECS {
+    // エンティティ -> 密配列インデックスの疎集合
+    // 疎側はページ単位で確保し、密側はエンティティを詰めて保持する
+    class SparseSet {
+    public:
+        static constexpr std::uint32_t INVALID_INDEX = ~std::uint32_t{0};
+
+        SparseSet() : sparse(INVALID_INDEX) {}
+
+        // 密側の容量と疎側のページを前もって確保する
+        void reserve(std::size_t capacity) {
+            dense.reserve(capacity);
+            sparse.reserve(capacity);
+        }
+
+        bool contains(Entity entity) const {
+            return sparse.get(entity) != INVALID_INDEX;
+        }
+
+        // contains() が true のエンティティに対してのみ呼ぶこと
+        std::size_t index(Entity entity) const {
+            return sparse[entity];
+        }
+
+        // 末尾に追加して密配列上のインデックスを返す（既に存在する場合はそのインデックス）
+        std::size_t insert(Entity entity) {
+            auto& slot = sparse.assure(entity);
+            if (slot == INVALID_INDEX) {
+                slot = static_cast<std::uint32_t>(dense.size());
+                dense.push_back(entity);
+            }
+            return slot;
+        }
+
+        // 末尾要素と入れ替えて削除する。呼び出し側は同じ入れ替えをペイロードにも行う
+        void erase(Entity entity) {
+            auto& slot = sparse[entity];
+            Entity lastEntity = dense.back();
+            dense[slot] = lastEntity;
+            sparse[lastEntity] = slot;
+            slot = INVALID_INDEX;
+            dense.pop_back();
+        }
+
+        // 密配列上の2つの位置を入れ替える。呼び出し側は同じ入れ替えをペイロードにも行う
+        void swapAt(std::size_t a, std::size_t b) {
+            Entity entityA = dense[a];
+            Entity entityB = dense[b];
+            dense[a] = entityB;
+            dense[b] = entityA;
+            sparse[entityA] = static_cast<std::uint32_t>(b);
+            sparse[entityB] = static_cast<std::uint32_t>(a);
+        }
+
+        std::size_t size() const { return dense.size(); }
+        bool empty() const { return dense.empty(); }
+        const Entity* data() const { return dense.data(); }
+
+        std::vector<Entity>::const_iterator begin() const { return dense.begin(); }
+        std::vector<Entity>::const_iterator end() const { return dense.end(); }
+
+    private:
+        std::vector<Entity> dense{};
+        PagedArray<std::uint32_t> sparse;
+    };
+}
@@ -1,11 +1,11 @@
-
 #pragma once
 #include "Types.hpp"
-#include <set>
+#include "SparseSet.hpp"
 
 namespace ECS {
     class System {
     public:
-        std::set<Entity> entities;
+        // 詰めた配列 + 疎インデックス。追加・削除は O(1)（削除は末尾との入れ替え）
+        SparseSet entities;
     };
 }
@@ -1,11 +1,13 @@
-
 #pragma once
 
 #include "System.hpp"
 #include "Types.hpp"
+#include "TypeId.hpp"
+#include <algorithm>
+#include <array>
 #include <memory>
-#include <unordered_map>
-#include <typeindex>
+#include <span>
+#include <vector>
 #include <stdexcept>
 
 namespace ECS {
@@ -13,51 +15,110 @@ namespace ECS {
     public:
         template<typename T>
         std::shared_ptr<T> registerSystem() {
-            const char* typeName = typeid(T).name();
+            std::size_t id = typeId<SystemFamily, T>;
 
-            if (systems.find(typeName) != systems.end()) {
+            if (id < systems.size() && systems[id]) {
                 throw std::runtime_error("Registering system more than once.");
             }
 
+            if (id >= systems.size()) {
+                systems.resize(id + 1);
+                signatures.resize(id + 1);
+            }
+
             auto system = std::make_shared<T>();
-            systems.insert({typeName, system});
+            systems[id] = system;
             return system;
         }
 
         template<typename T>
         void setSignature(Signature signature) {
-            const char* typeName = typeid(T).name();
+            std::size_t id = typeId<SystemFamily, T>;
 
-            if (systems.find(typeName) == systems.end()) {
+            if (id >= systems.size() || !systems[id]) {
                 throw std::runtime_error("System used before registered.");
             }
 
-            signatures.insert({typeName, signature});
+            signatures[id] = signature;
+
+            // コンポーネント型 -> そのコンポーネントをシグネチャに含むシステムの逆引き
+            for (auto& interested : systemsByComponent) {
+                interested.erase(std::remove(interested.begin(), interested.end(), id), interested.end());
+            }
+            for (std::size_t type = 0; type < MAX_COMPONENTS; ++type) {
+                if (signature.test(type)) {
+                    systemsByComponent[type].push_back(id);
+                }
+            }
         }
 
         void entityDestroyed(Entity entity) {
-            for (auto const& pair : systems) {
-                auto const& system = pair.second;
-                system->entities.erase(entity);
+            for (auto const& system : systems) {
+                if (system && system->entities.contains(entity)) {
+                    system->entities.erase(entity);
+                }
+            }
+        }
+
+        // システムごとにまとめて削除する
+        void entitiesDestroyed(std::span<const Entity> entities) {
+            for (auto const& system : systems) {
+                if (!system || system->entities.empty()) {
+                    continue;
+                }
+                for (Entity entity : entities) {
+                    if (system->entities.contains(entity)) {
+                        system->entities.erase(entity);
+                    }
+                }
             }
         }
 
+        // changedType を含むシグネチャのシステムだけを評価し直す
+        // （シグネチャが空のシステムにはエンティティは入らない）
+        void entitySignatureChanged(Entity entity, Signature entitySignature, ComponentType changedType) {
+            for (std::size_t id : systemsByComponent[changedType]) {
+                updateMembership(id, entity, entitySignature);
+            }
+        }
+
+        // すべてのシステムを評価し直す
         void entitySignatureChanged(Entity entity, Signature entitySignature) {
-            for (auto const& pair : systems) {
-                auto const& typeName = pair.first;
-                auto const& system = pair.second;
-                auto const& systemSignature = signatures[typeName];
-
-                if ((entitySignature & systemSignature) == systemSignature) {
-                    system->entities.insert(entity);
-                } else {
-                    system->entities.erase(entity);
+            for (std::size_t id = 0; id < systems.size(); ++id) {
+                if (systems[id]) {
+                    updateMembership(id, entity, entitySignature);
+                }
+            }
+        }
+
+        // 複数エンティティの変更を、影響を受けるシステムごとにまとめて評価し直す
+        void entitiesSignatureChanged(std::span<const Entity> entities, std::span<const Signature> entitySignatures,
+                                      Signature changedTypes) {
+            for (std::size_t id = 0; id < systems.size(); ++id) {
+                if (!systems[id] || (signatures[id] & changedTypes).none()) {
+                    continue;
+                }
+                for (std::size_t i = 0; i < entities.size(); ++i) {
+                    updateMembership(id, entities[i], entitySignatures[i]);
                 }
             }
         }
 
     private:
-        std::unordered_map<const char*, Signature> signatures{};
-        std::unordered_map<const char*, std::shared_ptr<System>> systems{};
+        // 添字は typeId<SystemFamily, T>
+        std::vector<Signature> signatures{};
+        std::vector<std::shared_ptr<System>> systems{};
+        std::array<std::vector<std::size_t>, MAX_COMPONENTS> systemsByComponent{};
+
+        void updateMembership(std::size_t id, Entity entity, Signature entitySignature) {
+            auto& members = systems[id]->entities;
+            auto const& systemSignature = signatures[id];
+
+            if ((entitySignature & systemSignature) == systemSignature) {
+                members.insert(entity);
+            } else if (members.contains(entity)) {
+                members.erase(entity);
+            }
+        }
     };
 }
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+namespace ECS {
+    struct ComponentFamily {};
+    struct SystemFamily {};
+
+    namespace detail {
+        template<typename Family>
+        std::size_t nextTypeId() {
+            static std::size_t counter = 0;
+            return counter++;
+        }
+    }
+
+    // Family ごとに型へ連番 ID を一度だけ割り当てる（プログラム開始時に確定する）
+    // 読み出しはただのグローバル変数の参照なので、ハッシュも typeid も使わない
+    // 静的初期化子の中からは参照しないこと（初期化順は未規定）
+    template<typename Family, typename T>
+    inline const std::size_t typeId = detail::nextTypeId<Family>();
+}
@@ -1,15 +1,34 @@
-
 #pragma once
 #include <cstdint>
 #include <bitset>
+#include <limits>
 #include <unordered_map>
 
 namespace ECS {
     using Entity = std::uint32_t;
-    const Entity MAX_ENTITIES = 5000;
+    // エンティティ数の上限は実行時に設定する（既定では ID 空間いっぱいまで）
+    const Entity UNLIMITED_ENTITIES = std::numeric_limits<Entity>::max();
+
+    // 世代付きのエンティティ参照。ID は破棄後に再利用されるので、フレームをまたいで保持する側はこちらを使う
+    // generation が 0 のハンドルはどのエンティティも指さない
+    struct EntityHandle {
+        Entity index = 0;
+        std::uint32_t generation = 0;
+
+        bool operator==(const EntityHandle&) const = default;
+    };
 
     using ComponentType = std::uint8_t;
     const ComponentType MAX_COMPONENTS = 32;
 
     using Signature = std::bitset<MAX_COMPONENTS>;
+
+    // コンポーネントの格納方式（Coordinator::init で選ぶ）
+    enum class StorageMode {
+        SparseSet, // 型ごとの疎集合と密配列。ビュー・SoA・変更追跡が使える
+        Archetype  // 同じシグネチャのエンティティを固定長チャンクにまとめる。走査は query() で行う
+    };
+
+    // 変更追跡の時刻。Coordinator::advanceChangeTick() で進む
+    using ChangeTick = std::uint32_t;
 }
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Types.hpp"
+#include "ComponentManager.hpp"
+#include "../Jobs/TaskGroup.hpp"
+#include <array>
+#include <tuple>
+#include <type_traits>
+
+namespace ECS {
+    template<typename... Ts>
+    struct TypeList {};
+
+    template<typename Include, typename Exclude = TypeList<>, typename Optional = TypeList<>>
+    class View;
+
+    // Includes をすべて持ち、Excludes をどれも持たないエンティティを走査するビュー
+    // Optionals は持っていればポインタ、持っていなければ nullptr として渡す
+    template<typename... Includes, typename... Excludes, typename... Optionals>
+    class View<TypeList<Includes...>, TypeList<Excludes...>, TypeList<Optionals...>> {
+        static_assert(sizeof...(Includes) > 0, "View needs at least one included component.");
+        static_assert((std::is_same_v<ComponentRef<Optionals>, Optionals&> && ...),
+                      "Optional components must use the default AoS layout.");
+
+    public:
+        explicit View(ComponentManager& manager)
+            : manager(&manager),
+              includeArrays(manager.getComponentArray<Includes>()...),
+              optionalArrays(manager.getComponentArray<Optionals>()...),
+              excludeSets{&manager.getComponentArray<Excludes>()->getEntitySet()...} {}
+
+        template<typename... Ts>
+        View<TypeList<Includes...>, TypeList<Excludes..., Ts...>, TypeList<Optionals...>> exclude() const {
+            return View<TypeList<Includes...>, TypeList<Excludes..., Ts...>, TypeList<Optionals...>>(*manager);
+        }
+
+        template<typename... Ts>
+        View<TypeList<Includes...>, TypeList<Excludes...>, TypeList<Optionals..., Ts...>> optional() const {
+            return View<TypeList<Includes...>, TypeList<Excludes...>, TypeList<Optionals..., Ts...>>(*manager);
+        }
+
+        bool contains(Entity entity) const {
+            return (std::get<ComponentArray<Includes>*>(includeArrays)->getEntitySet().contains(entity) && ...) &&
+                   isNotExcluded(entity);
+        }
+
+        template<typename T>
+        ComponentRef<T> get(Entity entity) {
+            return std::get<ComponentArray<T>*>(includeArrays)->getData(entity);
+        }
+
+        // 走査する候補数の上限（起点となる最小の密配列の大きさ）
+        std::size_t sizeHint() const {
+            return pivotSet().size();
+        }
+
+        // func(Entity, ComponentRef<Includes>..., Optionals*...) または func(ComponentRef<Includes>..., Optionals*...)
+        // ComponentRef は AoS の型なら T&、SoA の型ならプロキシ
+        // 起点の密配列を末尾から走査するので、処理中のエンティティ自身の削除は安全
+        template<typename Func>
+        void each(Func&& func) {
+            eachInRange(0, sizeHint(), func);
+        }
+
+        // 起点の密配列のインデックス範囲 [begin, end) だけを走査する（並列分割用）
+        template<typename Func>
+        void eachInRange(std::size_t begin, std::size_t end, Func&& func) {
+            const SparseSet& pivot = pivotSet();
+            const Entity* entities = pivot.data();
+
+            for (std::size_t index = end; index-- > begin;) {
+                Entity entity = entities[index];
+                if (!matches(entity, pivot)) {
+                    continue;
+                }
+
+                if constexpr (std::is_invocable_v<Func&, Entity, ComponentRef<Includes>..., Optionals*...>) {
+                    func(entity, fetch<Includes>(entity, index, pivot)..., fetchOptional<Optionals>(entity)...);
+                } else {
+                    func(fetch<Includes>(entity, index, pivot)..., fetchOptional<Optionals>(entity)...);
+                }
+            }
+        }
+
+        // each() を chunkSize 件ずつに分けてプール上で並列に実行する
+        // func は別スレッドから同時に呼ばれる。構造変更はコマンドバッファへ記録すること
+        template<typename Func>
+        void parallelEach(Jobs::ThreadPool& pool, Func&& func, std::size_t chunkSize = Jobs::DEFAULT_CHUNK_SIZE) {
+            Jobs::parallelFor(pool, 0, sizeHint(), chunkSize, [this, &func](std::size_t begin, std::size_t end) {
+                eachInRange(begin, end, func);
+            });
+        }
+
+        // 条件を満たすエンティティを、すべての Includes の配列の先頭 [0, count) へ同じ順序で集めて count を返す
+        // その範囲では streams<T>() の同じ添字が同じエンティティを指すので、まとめて処理するカーネルに渡せる
+        // 配列の並びを入れ替えるため、同じ配列を他のスレッドが触っている間に呼ばないこと
+        std::size_t pack() {
+            const SparseSet& pivot = pivotSet();
+            std::size_t count = 0;
+            for (std::size_t index = 0; index < pivot.size(); ++index) {
+                Entity entity = pivot.data()[index];
+                if (!matches(entity, pivot)) {
+                    continue;
+                }
+                (moveTo<Includes>(entity, count), ...);
+                ++count;
+            }
+            return count;
+        }
+
+        // pack() 後の密配列の生データ（SoA の型なら成分ごとの整列済みストリーム）
+        template<typename T>
+        typename ComponentArray<T>::Streams streams() {
+            return std::get<ComponentArray<T>*>(includeArrays)->streams();
+        }
+
+        // pack() 後の [0, count) に並ぶエンティティ
+        const Entity* packedEntities() const {
+            return std::get<0>(includeArrays)->getEntitySet().data();
+        }
+
+    private:
+        ComponentManager* manager;
+        std::tuple<ComponentArray<Includes>*...> includeArrays;
+        std::tuple<ComponentArray<Optionals>*...> optionalArrays;
+        std::array<const SparseSet*, sizeof...(Excludes)> excludeSets;
+
+        const SparseSet& pivotSet() const {
+            const SparseSet* pivot = nullptr;
+            ((pivot = (!pivot || std::get<ComponentArray<Includes>*>(includeArrays)->getEntitySet().size() < pivot->size())
+                          ? &std::get<ComponentArray<Includes>*>(includeArrays)->getEntitySet()
+                          : pivot), ...);
+            return *pivot;
+        }
+
+        bool isNotExcluded(Entity entity) const {
+            for (const SparseSet* set : excludeSets) {
+                if (set->contains(entity)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // 起点の配列は疎集合を引かずに密配列のインデックスで直接読む
+        bool matches(Entity entity, const SparseSet& pivot) const {
+            return ((&std::get<ComponentArray<Includes>*>(includeArrays)->getEntitySet() == &pivot ||
+                     std::get<ComponentArray<Includes>*>(includeArrays)->getEntitySet().contains(entity)) && ...) &&
+                   isNotExcluded(entity);
+        }
+
+        template<typename T>
+        void moveTo(Entity entity, std::size_t position) {
+            auto* array = std::get<ComponentArray<T>*>(includeArrays);
+            std::size_t current = array->getEntitySet().index(entity);
+            if (current != position) {
+                array->swapAt(current, position);
+            }
+        }
+
+        template<typename T>
+        ComponentRef<T> fetch(Entity entity, std::size_t index, const SparseSet& pivot) {
+            auto* array = std::get<ComponentArray<T>*>(includeArrays);
+            return &array->getEntitySet() == &pivot ? array->getDataAt(index) : array->getData(entity);
+        }
+
+        template<typename T>
+        T* fetchOptional(Entity entity) {
+            auto* array = std::get<ComponentArray<T>*>(optionalArrays);
+            return array->hasData(entity) ? &array->getData(entity) : nullptr;
+        }
+    };
+}
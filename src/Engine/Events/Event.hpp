@@ -1,13 +1,60 @@
-
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+
+// イベントのデータ。キューにそのまま積むので、ヒープを使わない値型にする
+// 同じフレームの同じ種類のイベントを足し合わせられる型は accumulate を用意する（EventManager::Coalesce::Accumulate）
+struct GeneratePointCloudPayload {
+    std::uint32_t count = 1000; // 生成する点の数
+
+    bool operator==(const GeneratePointCloudPayload&) const = default;
+};
+
+inline void accumulate(GeneratePointCloudPayload& into, const GeneratePointCloudPayload& from) {
+    into.count += from.count;
+}
+
+// オービットカメラの操作量（ラジアン・ワールド単位）
+struct CameraOrbitPayload {
+    float deltaYaw = 0.0f;
+    float deltaPitch = 0.0f;
+    float deltaRadius = 0.0f;
+
+    bool operator==(const CameraOrbitPayload&) const = default;
+};
+
+inline void accumulate(CameraOrbitPayload& into, const CameraOrbitPayload& from) {
+    into.deltaYaw += from.deltaYaw;
+    into.deltaPitch += from.deltaPitch;
+    into.deltaRadius += from.deltaRadius;
+}
+
 struct Event {
-    enum Type {
+    enum Type : std::uint8_t {
         None,
         GeneratePointCloud,
         SwitchCoordinateSystem,
+        CameraOrbit,
         // その他のイベントタイプ
+        TypeCount
     } type;
 
-    // イベントデータ（必要に応じて追加）
+    // イベントデータ（必要に応じて型を追加）
+    using Payload = std::variant<std::monostate, GeneratePointCloudPayload, CameraOrbitPayload>;
+    Payload payload{};
+
+    // 何件のイベントをまとめたものか（まとめていなければ 1）
+    std::uint32_t count = 1;
+
+    bool operator==(const Event&) const = default;
+
+    // 指定した型のデータを持っていればそのポインタ、持っていなければ nullptr
+    template<typename T>
+    const T* get() const {
+        return std::get_if<T>(&payload);
+    }
 };
+
+static_assert(std::is_trivially_copyable_v<Event>, "Events are copied through a lock-free queue.");
@@ -1,37 +1,139 @@
-
 #pragma once
 
 #include "Event.hpp"
-#include <queue>
+#include "MpscQueue.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <functional>
-#include <unordered_map>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
+// どのスレッドからでも sendEvent でき、メインループが processEvents でまとめて配る
+// キューは容量固定のロックフリー MPSC なので、送信時にロックもヒープ確保も発生しない
+// addListener・setCoalescing・processEvents はメインスレッドから呼ぶ
 class EventManager {
 public:
     using EventHandler = std::function<void(const Event&)>;
 
+    // 1回の processEvents に同じ種類のイベントが複数あったときのまとめ方
+    // まとめたイベントは最初の1件の位置で配られ、count にまとめた件数が入る
+    enum class Coalesce {
+        None,       // まとめずにすべて配る
+        Merge,      // 最初の1件だけを配る
+        KeepLast,   // 最後の1件のデータで配る
+        Accumulate  // データを accumulate で足し合わせて配る（accumulate が無い型は KeepLast と同じ）
+    };
+
+    static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+    // capacity は 2 のべき乗
+    explicit EventManager(std::size_t capacity = DEFAULT_CAPACITY) : eventQueue(capacity) {
+        pending.reserve(capacity);
+    }
+
     void addListener(Event::Type eventType, EventHandler handler) {
-        listeners[eventType].push_back(handler);
+        listeners[eventType].push_back(std::move(handler));
+    }
+
+    void setCoalescing(Event::Type eventType, Coalesce policy) {
+        policies[eventType] = policy;
     }
 
-    void sendEvent(const Event& event) {
-        eventQueue.push(event);
+    // 配る直前の（まとめた後の）イベントを受け取る。記録や再生の照合に使う
+    void setDispatchObserver(EventHandler observer) {
+        dispatchObserver = std::move(observer);
     }
 
+    // キューが満杯なら捨てて false を返す（数は takeDroppedCount で分かる）
+    bool sendEvent(const Event& event) {
+        if (!eventQueue.tryPush(event)) {
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // 呼び出し時点で届いているイベントを配る。処理中に送られたイベントは次回に回す
+    // 送り続けられても止まらないよう、一度に取り出すのはキューの容量まで
     void processEvents() {
-        while (!eventQueue.empty()) {
-            Event event = eventQueue.front();
-            eventQueue.pop();
+        Event event;
+        while (pending.size() < eventQueue.capacity() && eventQueue.tryPop(event)) {
+            pending.push_back(event);
+        }
+        coalesce();
 
-            auto& handlers = listeners[event.type];
-            for (auto& handler : handlers) {
-                handler(event);
+        for (const Event& queued : pending) {
+            if (dispatchObserver) {
+                dispatchObserver(queued);
+            }
+            for (auto& handler : listeners[queued.type]) {
+                handler(queued);
             }
         }
+        pending.clear();
+    }
+
+    // 前回呼んでから満杯で捨てたイベントの数
+    std::size_t takeDroppedCount() {
+        return droppedEvents.exchange(0, std::memory_order_relaxed);
     }
 
 private:
-    std::unordered_map<Event::Type, std::vector<EventHandler>> listeners;
-    std::queue<Event> eventQueue;
+    static constexpr std::size_t NO_SLOT = ~std::size_t{0};
+
+    // イベントの種類をそのまま添字にした配送表
+    std::array<std::vector<EventHandler>, Event::TypeCount> listeners{};
+    std::array<Coalesce, Event::TypeCount> policies{};
+    EventHandler dispatchObserver{};
+    Events::MpscQueue<Event> eventQueue;
+    std::atomic<std::size_t> droppedEvents{0};
+    // processEvents で取り出したイベント（確保し直さないよう使い回す）
+    std::vector<Event> pending{};
+
+    // pending を種類ごとの方針に従ってその場で詰める
+    void coalesce() {
+        std::array<std::size_t, Event::TypeCount> slots;
+        slots.fill(NO_SLOT);
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            const Event& event = pending[i];
+            Coalesce policy = policies[event.type];
+            std::size_t& slot = slots[event.type];
+            if (policy == Coalesce::None || slot == NO_SLOT) {
+                if (policy != Coalesce::None) {
+                    slot = kept;
+                }
+                pending[kept++] = event;
+                continue;
+            }
+
+            Event& merged = pending[slot];
+            std::uint32_t count = merged.count + event.count;
+            if (policy == Coalesce::KeepLast) {
+                merged = event;
+            } else if (policy == Coalesce::Accumulate) {
+                accumulatePayload(merged.payload, event.payload);
+            }
+            merged.count = count;
+        }
+        pending.resize(kept);
+    }
+
+    static void accumulatePayload(Event::Payload& into, const Event::Payload& from) {
+        if (into.index() != from.index()) {
+            into = from;
+            return;
+        }
+        std::visit([&from](auto& target) {
+            using T = std::decay_t<decltype(target)>;
+            if constexpr (requires(T& a, const T& b) { accumulate(a, b); }) {
+                accumulate(target, std::get<T>(from));
+            } else {
+                target = std::get<T>(from);
+            }
+        }, into);
+    }
 };
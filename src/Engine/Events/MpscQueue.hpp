@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Events {
+    constexpr std::size_t QUEUE_CACHE_LINE_SIZE = 64;
+
+    // 容量固定・ロックフリーの複数生産者/単一消費者キュー
+    // 各スロットの通し番号で「書き込み済み」「読み出し済み」を判定する（Vyukov 方式のリングバッファ）
+    // tryPush はどのスレッドから呼んでもよく、tryPop は常に同じ1スレッドから呼ぶこと
+    template<typename T>
+    class MpscQueue {
+        static_assert(std::is_trivially_copyable_v<T>, "MpscQueue stores trivially copyable values only.");
+
+    public:
+        // capacity は 2 のべき乗
+        explicit MpscQueue(std::size_t capacity)
+            : slots(std::make_unique<Slot[]>(capacity)), mask(capacity - 1) {
+            if (capacity < 2 || (capacity & mask) != 0) {
+                throw std::invalid_argument("MpscQueue capacity must be a power of two.");
+            }
+            for (std::size_t i = 0; i < capacity; ++i) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        // 満杯なら何もせず false
+        bool tryPush(const T& value) {
+            std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+            Slot* slot;
+            for (;;) {
+                slot = &slots[position & mask];
+                std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+                if (difference == 0) {
+                    if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = value;
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // 空なら false。書き込み途中のスロットに当たった場合も空として扱う
+        bool tryPop(T& value) {
+            Slot& slot = slots[dequeuePosition & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+                return false;
+            }
+            value = slot.value;
+            slot.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+            ++dequeuePosition;
+            return true;
+        }
+
+        std::size_t capacity() const {
+            return mask + 1;
+        }
+
+    private:
+        struct alignas(QUEUE_CACHE_LINE_SIZE) Slot {
+            std::atomic<std::size_t> sequence{0};
+            T value{};
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        const std::size_t mask;
+        // 生産者どうしが奪い合う位置と消費者だけが触る位置は別のキャッシュラインに置く
+        alignas(QUEUE_CACHE_LINE_SIZE) std::atomic<std::size_t> enqueuePosition{0};
+        alignas(QUEUE_CACHE_LINE_SIZE) std::size_t dequeuePosition = 0;
+    };
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "Event.hpp"
+#include "EventManager.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// 予約したタイマーの識別子。解放済みの枠を指す古い ID は世代で見分ける
+struct TimerId {
+    std::uint32_t index = ~std::uint32_t{0};
+    std::uint32_t generation = 0;
+
+    bool valid() const {
+        return index != ~std::uint32_t{0};
+    }
+};
+
+// 階層タイマーホイール
+// 時刻を tick（既定 1 ms）単位で数え、64 枠 × 4 段のリングに期限ごとに振り分ける
+// 下の段が一周するたびに上の段の1枠を下へ振り分け直すので、予約と取り消しは O(1)、
+// 1 フレームの処理は進めた tick 数と期限を迎えたタイマー数に比例する
+// 期限を迎えたタイマーは advance() の最後に期限順でまとめて実行する。メインスレッドから使うこと
+class TimerWheel {
+public:
+    using Callback = std::function<void()>;
+
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr std::size_t SLOTS = std::size_t{1} << SLOT_BITS;
+    static constexpr std::size_t LEVELS = 4;
+
+    explicit TimerWheel(double tickSeconds = 0.001) : tickSeconds(tickSeconds) {
+        heads.fill(NONE);
+    }
+
+    // 設定されていれば scheduleEvent の期限でこのマネージャーにイベントを送る
+    void setEventManager(EventManager* manager) {
+        eventManager = manager;
+    }
+
+    // delay 秒後に callback を呼ぶ。period が正なら以後 period 秒ごとに繰り返す
+    TimerId schedule(float delaySeconds, Callback callback, float periodSeconds = 0.0f) {
+        std::uint32_t index = allocate(periodSeconds);
+        timers[index].callback = std::move(callback);
+        timers[index].sendsEvent = false;
+        insert(index, now + toTicks(delaySeconds), now + 1);
+        return TimerId{index, timers[index].generation};
+    }
+
+    // delay 秒後に event を送る。period が正なら以後 period 秒ごとに繰り返す
+    TimerId scheduleEvent(float delaySeconds, const Event& event, float periodSeconds = 0.0f) {
+        std::uint32_t index = allocate(periodSeconds);
+        timers[index].event = event;
+        timers[index].sendsEvent = true;
+        insert(index, now + toTicks(delaySeconds), now + 1);
+        return TimerId{index, timers[index].generation};
+    }
+
+    // 予約を取り消す。既に実行済み（一度きり）や取り消し済みなら false
+    bool cancel(TimerId id) {
+        if (!isActive(id)) {
+            return false;
+        }
+        Timer& timer = timers[id.index];
+        if (timer.slot != NONE) {
+            unlink(id.index);
+        }
+        release(id.index);
+        return true;
+    }
+
+    bool isActive(TimerId id) const {
+        return id.valid() && id.index < timers.size() && timers[id.index].generation == id.generation &&
+               timers[id.index].inUse;
+    }
+
+    // 時計を deltaTime 秒進め、期限を迎えたタイマーを実行する
+    void advance(float deltaTime) {
+        // 丸め誤差で tick の境目をわずかに取りこぼさないよう、ごく小さな余裕を持たせて切り捨てる
+        tickRemainder += static_cast<double>(deltaTime) / tickSeconds;
+        auto ticks = static_cast<std::uint64_t>(std::max(tickRemainder + 1e-4, 0.0));
+        tickRemainder -= static_cast<double>(ticks);
+
+        // 予約が無ければ枠を見て回らずに時計だけ進める
+        if (activeCount == 0) {
+            now += ticks;
+            return;
+        }
+
+        for (std::uint64_t i = 0; i < ticks; ++i) {
+            processTick();
+        }
+        runExpired();
+    }
+
+    // 時計の現在時刻（秒）
+    double getTime() const {
+        return (static_cast<double>(now) + tickRemainder) * tickSeconds;
+    }
+
+    std::size_t getActiveCount() const {
+        return activeCount;
+    }
+
+private:
+    static constexpr std::uint32_t NONE = ~std::uint32_t{0};
+    static constexpr std::uint64_t SLOT_MASK = SLOTS - 1;
+    // 一度に振り分けられる最大の遅れ（これより先の期限は最上段で待たせて振り分け直す）
+    static constexpr std::uint64_t MAX_DELTA = (std::uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+
+    struct Timer {
+        std::uint64_t deadline = 0;  // 期限の tick
+        std::uint64_t period = 0;    // 繰り返し間隔の tick（0 なら一度きり）
+        std::uint32_t next = NONE;   // 同じ枠の双方向リスト
+        std::uint32_t prev = NONE;
+        std::uint32_t slot = NONE;   // 入っている枠（level * SLOTS + index）
+        std::uint32_t generation = 0;
+        bool inUse = false;
+        bool sendsEvent = false;
+        Event event{};
+        Callback callback{};
+    };
+
+    struct Expired {
+        std::uint32_t index;
+        std::uint32_t generation;
+    };
+
+    double tickSeconds;
+    double tickRemainder = 0.0;
+    std::uint64_t now = 0; // 処理済みの最後の tick
+    std::vector<Timer> timers{};
+    std::vector<std::uint32_t> freeList{};
+    std::array<std::uint32_t, LEVELS * SLOTS> heads{};
+    std::vector<Expired> expired{};
+    std::size_t activeCount = 0;
+    EventManager* eventManager = nullptr;
+
+    std::uint64_t toTicks(float seconds) const {
+        if (!(seconds > 0.0f)) {
+            return 0;
+        }
+        return static_cast<std::uint64_t>(std::llround(static_cast<double>(seconds) / tickSeconds));
+    }
+
+    std::uint32_t allocate(float periodSeconds) {
+        std::uint32_t index;
+        if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(timers.size());
+            timers.emplace_back();
+        }
+        Timer& timer = timers[index];
+        timer.inUse = true;
+        // 0 間隔の繰り返しは同じ tick で止まらなくなるので最短 1 tick にする
+        timer.period = periodSeconds > 0.0f ? std::max<std::uint64_t>(toTicks(periodSeconds), 1) : 0;
+        ++activeCount;
+        return index;
+    }
+
+    void release(std::uint32_t index) {
+        Timer& timer = timers[index];
+        timer.inUse = false;
+        timer.callback = nullptr;
+        ++timer.generation;
+        freeList.push_back(index);
+        --activeCount;
+    }
+
+    // 期限までの残りに応じた段の枠へ入れる。earliest より前の期限は earliest で実行する
+    void insert(std::uint32_t index, std::uint64_t deadline, std::uint64_t earliest) {
+        Timer& timer = timers[index];
+        timer.deadline = deadline;
+
+        std::uint64_t target = std::max(deadline, earliest);
+        std::uint64_t delta = target - now;
+        if (delta > MAX_DELTA) {
+            target = now + MAX_DELTA;
+            delta = MAX_DELTA;
+        }
+
+        std::size_t level = 0;
+        while (level + 1 < LEVELS && delta >= (std::uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+        auto slot = static_cast<std::uint32_t>(level * SLOTS + ((target >> (SLOT_BITS * level)) & SLOT_MASK));
+
+        timer.slot = slot;
+        timer.prev = NONE;
+        timer.next = heads[slot];
+        if (heads[slot] != NONE) {
+            timers[heads[slot]].prev = index;
+        }
+        heads[slot] = index;
+    }
+
+    void unlink(std::uint32_t index) {
+        Timer& timer = timers[index];
+        if (timer.prev != NONE) {
+            timers[timer.prev].next = timer.next;
+        } else {
+            heads[timer.slot] = timer.next;
+        }
+        if (timer.next != NONE) {
+            timers[timer.next].prev = timer.prev;
+        }
+        timer.slot = timer.prev = timer.next = NONE;
+    }
+
+    // 枠を空にして中身のリストの先頭を返す
+    std::uint32_t detachSlot(std::uint32_t slot) {
+        std::uint32_t head = heads[slot];
+        heads[slot] = NONE;
+        return head;
+    }
+
+    void processTick() {
+        ++now;
+
+        // 下の段が一周したら、上の段の今の枠を振り分け直す（期限が今の tick のものはこの後すぐ実行される）
+        std::size_t index = now & SLOT_MASK;
+        for (std::size_t level = 1; index == 0 && level < LEVELS; ++level) {
+            index = (now >> (SLOT_BITS * level)) & SLOT_MASK;
+            std::uint32_t node = detachSlot(static_cast<std::uint32_t>(level * SLOTS + index));
+            while (node != NONE) {
+                std::uint32_t next = timers[node].next;
+                insert(node, timers[node].deadline, now);
+                node = next;
+            }
+        }
+
+        std::uint32_t node = detachSlot(static_cast<std::uint32_t>(now & SLOT_MASK));
+        while (node != NONE) {
+            Timer& timer = timers[node];
+            std::uint32_t next = timer.next;
+            timer.slot = timer.prev = timer.next = NONE;
+            if (timer.deadline > now) {
+                // 最上段に収まらない遠い期限だったもの
+                insert(node, timer.deadline, now + 1);
+            } else {
+                expired.push_back(Expired{node, timer.generation});
+                if (timer.period > 0) {
+                    // 期限から数えて次を予約する（実行が遅れてもずれが積もらない）
+                    // 今の枠は処理済みなので、追いつかない分は次の tick に回す
+                    insert(node, timer.deadline + timer.period, now + 1);
+                }
+            }
+            node = next;
+        }
+    }
+
+    // コールバックの中で予約や取り消しをしてもよい
+    void runExpired() {
+        for (std::size_t i = 0; i < expired.size(); ++i) {
+            Expired entry = expired[i];
+            if (timers[entry.index].generation != entry.generation || !timers[entry.index].inUse) {
+                continue; // 実行前に取り消された
+            }
+            Timer& timer = timers[entry.index];
+            bool oneShot = timer.period == 0;
+            if (timer.sendsEvent) {
+                if (eventManager) {
+                    eventManager->sendEvent(timer.event);
+                }
+            } else if (timer.callback) {
+                // コールバック中の予約で timers が再確保されても安全なように、実行中は退避しておく
+                Callback callback = std::move(timer.callback);
+                callback();
+                Timer& current = timers[entry.index];
+                if (current.generation == entry.generation && current.inUse && !current.callback) {
+                    current.callback = std::move(callback);
+                }
+            }
+            Timer& finished = timers[entry.index];
+            if (oneShot && finished.generation == entry.generation && finished.inUse) {
+                release(entry.index);
+            }
+        }
+        expired.clear();
+    }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+namespace Jobs {
+    // parallelFor の既定の分割サイズ（要素数）
+    const std::size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    // fork/join 用のタスクグループ。wait() は完了を待つ間もプールのジョブを手伝って実行する
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+
+        ~TaskGroup() {
+            wait();
+        }
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        template<typename Func>
+        void run(Func&& func) {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            pool.submit([this, func = std::forward<Func>(func)]() mutable {
+                func();
+                pending.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        void wait() {
+            while (pending.load(std::memory_order_acquire) > 0) {
+                if (!pool.tryRunPendingJob()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    private:
+        ThreadPool& pool;
+        std::atomic<std::size_t> pending{0};
+    };
+
+    // [begin, end) を chunkSize ごとに分割し、func(chunkBegin, chunkEnd) を並列に呼ぶ
+    // 呼び出し元のスレッドも最初の区間を受け持つ
+    template<typename Func>
+    void parallelFor(ThreadPool& pool, std::size_t begin, std::size_t end, std::size_t chunkSize, Func&& func) {
+        if (end <= begin) {
+            return;
+        }
+        chunkSize = std::max<std::size_t>(chunkSize, 1);
+        if (pool.getWorkerCount() == 0 || end - begin <= chunkSize) {
+            func(begin, end);
+            return;
+        }
+
+        TaskGroup group(pool);
+        for (std::size_t chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize) {
+            std::size_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+            group.run([&func, chunkBegin, chunkEnd]() { func(chunkBegin, chunkEnd); });
+        }
+        func(begin, std::min(begin + chunkSize, end));
+        group.wait();
+    }
+}
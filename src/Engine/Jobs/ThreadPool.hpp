@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Jobs {
+    // ワークスティーリング方式のスレッドプール
+    // ワーカーごとに両端キューを持ち、自分のキューは末尾（LIFO）から、
+    // 他のワーカーのキューは先頭（FIFO）から盗んで実行する
+    class ThreadPool {
+    public:
+        using Job = std::function<void()>;
+
+        // workerCount が 0 ならハードウェアスレッド数 - 1（メインスレッドの分を空ける）
+        explicit ThreadPool(std::size_t workerCount = 0) {
+            if (workerCount == 0) {
+                unsigned int hardware = std::thread::hardware_concurrency();
+                workerCount = hardware > 1 ? hardware - 1 : 0;
+            }
+            for (std::size_t i = 0; i < workerCount; ++i) {
+                queues.push_back(std::make_unique<WorkQueue>());
+            }
+            for (std::size_t i = 0; i < workerCount; ++i) {
+                workers.emplace_back([this, i]() { workerLoop(i); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                stopping = true;
+            }
+            sleepCondition.notify_all();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // ワーカーから呼ばれたら自分のキューへ、それ以外は順番に各ワーカーへ配る
+        // ワーカーがいなければ呼び出し元でそのまま実行する
+        void submit(Job job) {
+            if (workers.empty()) {
+                job();
+                return;
+            }
+
+            std::size_t target = currentPool == this
+                                     ? currentWorker
+                                     : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+            // 先に数を増やしておく（取り出し側の減算が先行して負にならないように）
+            queuedJobs.fetch_add(1, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(queues[target]->mutex);
+                queues[target]->jobs.push_back(std::move(job));
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+            }
+            sleepCondition.notify_one();
+        }
+
+        // 待機中のスレッドが手伝うために使う。実行できるジョブが無ければ false
+        bool tryRunPendingJob() {
+            Job job;
+            if (!tryPop(currentPool == this ? currentWorker : queues.size(), job)) {
+                return false;
+            }
+            job();
+            return true;
+        }
+
+        std::size_t getWorkerCount() const {
+            return workers.size();
+        }
+
+    private:
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> queuedJobs{0};
+        std::atomic<std::size_t> nextQueue{0};
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        bool stopping = false;
+
+        inline static thread_local ThreadPool* currentPool = nullptr;
+        inline static thread_local std::size_t currentWorker = 0;
+
+        // self が queues.size() ならワーカー以外のスレッド（盗むだけ）
+        bool tryPop(std::size_t self, Job& job) {
+            if (queuedJobs.load(std::memory_order_acquire) == 0) {
+                return false;
+            }
+
+            if (self < queues.size()) {
+                auto& own = *queues[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.jobs.empty()) {
+                    job = std::move(own.jobs.back());
+                    own.jobs.pop_back();
+                    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+
+            for (std::size_t offset = 1; offset <= queues.size(); ++offset) {
+                auto& victim = *queues[(self + offset) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.jobs.empty()) {
+                    job = std::move(victim.jobs.front());
+                    victim.jobs.pop_front();
+                    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void workerLoop(std::size_t index) {
+            currentPool = this;
+            currentWorker = index;
+
+            for (;;) {
+                Job job;
+                if (tryPop(index, job)) {
+                    job();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                sleepCondition.wait(lock, [this]() {
+                    return stopping || queuedJobs.load(std::memory_order_acquire) > 0;
+                });
+                if (stopping && queuedJobs.load(std::memory_order_acquire) == 0) {
+                    return;
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "../Simd/ScreenProjection.hpp"
+#include "../Jobs/TaskGroup.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace Raster {
+    // 投影済みの点を Z バッファつきの円（スプラット）として CPU のフレームバッファに塗る
+    // 画面を TILE_SIZE 四方のタイルに分け、点を重なるタイルへ振り分けてから、タイルごとに並列に塗る
+    // 各画素は必ず一つのタイル（一つのワーカー）だけが書くので、ロックなしで奥行き比較ができる
+    class TiledRasterizer {
+    public:
+        static constexpr int TILE_SIZE = 64;
+        // 振り分けの分割単位（点の数）
+        static constexpr std::size_t BIN_CHUNK_SIZE = 16384;
+
+        void resize(int width, int height) {
+            this->width = std::max(width, 0);
+            this->height = std::max(height, 0);
+            tilesX = (this->width + TILE_SIZE - 1) / TILE_SIZE;
+            tilesY = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+            depthBuffer.assign(static_cast<std::size_t>(this->width) * this->height, 0.0f);
+        }
+
+        int getWidth() const {
+            return width;
+        }
+
+        int getHeight() const {
+            return height;
+        }
+
+        // 半径 (splatScale / 奥行き) ピクセルの円の上限と下限
+        void setRadiusRange(float minRadius, float maxRadius) {
+            this->minRadius = std::max(minRadius, 0.5f);
+            this->maxRadius = std::max(maxRadius, this->minRadius);
+        }
+
+        // points を ARGB8888 の pixels（1 行 pitch バイト、width x height）へ塗る。点の無い画素は clearColor
+        // 奥行きが等しい点どうしは添字の小さい方が残るので、結果はワーカー数によらない
+        void render(const Simd::ScreenProjection& points, float splatScale, std::uint32_t color,
+                    std::uint32_t clearColor, void* pixels, int pitch, Jobs::ThreadPool* pool = nullptr) {
+            if (width == 0 || height == 0) {
+                return;
+            }
+            bin(points, splatScale, pool);
+
+            auto rasterizeTiles = [&](std::size_t begin, std::size_t end) {
+                for (std::size_t tile = begin; tile < end; ++tile) {
+                    rasterizeTile(tile, points, color, clearColor, static_cast<std::uint8_t*>(pixels), pitch);
+                }
+            };
+            std::size_t tileCount = static_cast<std::size_t>(tilesX) * tilesY;
+            if (pool) {
+                Jobs::parallelFor(*pool, 0, tileCount, 1, rasterizeTiles);
+            } else {
+                rasterizeTiles(0, tileCount);
+            }
+        }
+
+    private:
+        int width = 0;
+        int height = 0;
+        int tilesX = 0;
+        int tilesY = 0;
+        float minRadius = 0.5f;
+        float maxRadius = 16.0f;
+        std::vector<float> depthBuffer{};
+        // 点ごとの半径（ピクセル）
+        std::vector<float> radii{};
+        // 分割単位 c・タイル t ごとの点の数（c * タイル数 + t）。数えた後は書き込み位置になる
+        std::vector<std::uint32_t> binCursors{};
+        // タイル t の点は binnedPoints[tileStarts[t], tileStarts[t + 1]) に添字の昇順で並ぶ
+        std::vector<std::uint32_t> tileStarts{};
+        std::vector<std::uint32_t> binnedPoints{};
+
+        struct TileRange {
+            int x0, y0, x1, y1; // 含む
+        };
+
+        TileRange tileRange(std::int32_t x, std::int32_t y, float radius) const {
+            float centerX = static_cast<float>(x) + 0.5f;
+            float centerY = static_cast<float>(y) + 0.5f;
+            int left = std::max(static_cast<int>(centerX - radius), 0);
+            int top = std::max(static_cast<int>(centerY - radius), 0);
+            int right = std::min(static_cast<int>(centerX + radius), width - 1);
+            int bottom = std::min(static_cast<int>(centerY + radius), height - 1);
+            return TileRange{left / TILE_SIZE, top / TILE_SIZE, right / TILE_SIZE, bottom / TILE_SIZE};
+        }
+
+        // 点を重なるタイルへ振り分ける
+        // 分割単位ごとに数え、(タイル, 分割単位) の順に累積して書き込み位置を決めてから詰めるので、並列でも順序は決まる
+        void bin(const Simd::ScreenProjection& points, float splatScale, Jobs::ThreadPool* pool) {
+            std::size_t count = points.size();
+            std::size_t tileCount = static_cast<std::size_t>(tilesX) * tilesY;
+            std::size_t chunks = (count + BIN_CHUNK_SIZE - 1) / BIN_CHUNK_SIZE;
+            radii.resize(count);
+            binCursors.assign(chunks * tileCount, 0);
+
+            const std::int32_t* xs = points.screenX();
+            const std::int32_t* ys = points.screenY();
+            const float* depths = points.depth();
+
+            auto forEachChunk = [&](auto&& func) {
+                auto run = [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t chunk = begin; chunk < end; ++chunk) {
+                        func(chunk, chunk * BIN_CHUNK_SIZE, std::min(count, (chunk + 1) * BIN_CHUNK_SIZE));
+                    }
+                };
+                if (pool) {
+                    Jobs::parallelFor(*pool, 0, chunks, 1, run);
+                } else {
+                    run(0, chunks);
+                }
+            };
+
+            forEachChunk([&](std::size_t chunk, std::size_t begin, std::size_t end) {
+                std::uint32_t* counts = binCursors.data() + chunk * tileCount;
+                for (std::size_t k = begin; k < end; ++k) {
+                    radii[k] = std::clamp(splatScale / depths[k], minRadius, maxRadius);
+                    TileRange range = tileRange(xs[k], ys[k], radii[k]);
+                    for (int ty = range.y0; ty <= range.y1; ++ty) {
+                        for (int tx = range.x0; tx <= range.x1; ++tx) {
+                            ++counts[ty * tilesX + tx];
+                        }
+                    }
+                }
+            });
+
+            tileStarts.resize(tileCount + 1);
+            std::uint32_t total = 0;
+            for (std::size_t tile = 0; tile < tileCount; ++tile) {
+                tileStarts[tile] = total;
+                for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                    std::uint32_t& cursor = binCursors[chunk * tileCount + tile];
+                    std::uint32_t n = cursor;
+                    cursor = total;
+                    total += n;
+                }
+            }
+            tileStarts[tileCount] = total;
+            binnedPoints.resize(total);
+
+            forEachChunk([&](std::size_t chunk, std::size_t begin, std::size_t end) {
+                std::uint32_t* cursors = binCursors.data() + chunk * tileCount;
+                for (std::size_t k = begin; k < end; ++k) {
+                    TileRange range = tileRange(xs[k], ys[k], radii[k]);
+                    for (int ty = range.y0; ty <= range.y1; ++ty) {
+                        for (int tx = range.x0; tx <= range.x1; ++tx) {
+                            binnedPoints[cursors[ty * tilesX + tx]++] = static_cast<std::uint32_t>(k);
+                        }
+                    }
+                }
+            });
+        }
+
+        void rasterizeTile(std::size_t tile, const Simd::ScreenProjection& points, std::uint32_t color,
+                           std::uint32_t clearColor, std::uint8_t* pixels, int pitch) {
+            int tileLeft = static_cast<int>(tile % tilesX) * TILE_SIZE;
+            int tileTop = static_cast<int>(tile / tilesX) * TILE_SIZE;
+            int tileRight = std::min(tileLeft + TILE_SIZE, width);   // 含まない
+            int tileBottom = std::min(tileTop + TILE_SIZE, height);  // 含まない
+
+            for (int y = tileTop; y < tileBottom; ++y) {
+                auto* row = reinterpret_cast<std::uint32_t*>(pixels + static_cast<std::ptrdiff_t>(y) * pitch);
+                std::fill(row + tileLeft, row + tileRight, clearColor);
+                float* depthRow = depthBuffer.data() + static_cast<std::size_t>(y) * width;
+                std::fill(depthRow + tileLeft, depthRow + tileRight, std::numeric_limits<float>::infinity());
+            }
+
+            const std::int32_t* xs = points.screenX();
+            const std::int32_t* ys = points.screenY();
+            const float* depths = points.depth();
+            for (std::uint32_t slot = tileStarts[tile]; slot < tileStarts[tile + 1]; ++slot) {
+                std::uint32_t k = binnedPoints[slot];
+                float radius = radii[k];
+                float depth = depths[k];
+                float centerX = static_cast<float>(xs[k]) + 0.5f;
+                float centerY = static_cast<float>(ys[k]) + 0.5f;
+                int left = std::max(static_cast<int>(centerX - radius), tileLeft);
+                int top = std::max(static_cast<int>(centerY - radius), tileTop);
+                int right = std::min(static_cast<int>(centerX + radius) + 1, tileRight);
+                int bottom = std::min(static_cast<int>(centerY + radius) + 1, tileBottom);
+                float radiusSquared = radius * radius;
+
+                for (int y = top; y < bottom; ++y) {
+                    float dy = static_cast<float>(y) + 0.5f - centerY;
+                    auto* row = reinterpret_cast<std::uint32_t*>(pixels + static_cast<std::ptrdiff_t>(y) * pitch);
+                    float* depthRow = depthBuffer.data() + static_cast<std::size_t>(y) * width;
+                    for (int x = left; x < right; ++x) {
+                        float dx = static_cast<float>(x) + 0.5f - centerX;
+                        if (dx * dx + dy * dy <= radiusSquared && depth < depthRow[x]) {
+                            depthRow[x] = depth;
+                            row[x] = color;
+                        }
+                    }
+                }
+            }
+        }
+    };
+}
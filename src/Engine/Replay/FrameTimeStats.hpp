@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace Replay {
+    // フレーム時間の分布の要約（ミリ秒）
+    struct FrameTimeSummary {
+        std::size_t frames = 0;
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    // 各フレームの実時間を集め、ビルドどうしで比べるための分布を出す
+    class FrameTimeStats {
+    public:
+        void add(double milliseconds) {
+            samples.push_back(milliseconds);
+        }
+
+        FrameTimeSummary summarize() const {
+            FrameTimeSummary summary;
+            summary.frames = samples.size();
+            if (samples.empty()) {
+                return summary;
+            }
+
+            std::vector<double> sorted = samples;
+            std::sort(sorted.begin(), sorted.end());
+            double total = 0.0;
+            for (double sample : sorted) {
+                total += sample;
+            }
+            summary.mean = total / static_cast<double>(sorted.size());
+            summary.p50 = percentile(sorted, 0.50);
+            summary.p90 = percentile(sorted, 0.90);
+            summary.p99 = percentile(sorted, 0.99);
+            summary.max = sorted.back();
+            return summary;
+        }
+
+    private:
+        std::vector<double> samples;
+
+        // 最近傍順位による百分位
+        static double percentile(const std::vector<double>& sorted, double fraction) {
+            auto rank = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+            return sorted[std::min(rank, sorted.size() - 1)];
+        }
+    };
+}
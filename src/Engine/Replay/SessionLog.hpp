@@ -0,0 +1,187 @@
+#pragma once
+
+#include "../Events/Event.hpp"
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Replay {
+    // 1フレーム分の記録：そのフレームの経過時間、受け取った入力、配られたイベント
+    struct FrameRecord {
+        float deltaTime = 0.0f;
+        std::vector<SDL_Event> inputs;
+        std::vector<Event> events;
+
+        void clear() {
+            deltaTime = 0.0f;
+            inputs.clear();
+            events.clear();
+        }
+    };
+
+    // 記録ファイルの形式（リトルエンディアン、同じビルドどうしでの再生を前提に構造体をそのまま書く）
+    // ヘッダー: magic, version, sizeof(SDL_Event), sizeof(Event), seed
+    // フレーム: deltaTime(float), 入力数(u32), イベント数(u32), SDL_Event × 入力数, Event × イベント数
+    namespace detail {
+        constexpr std::uint32_t SESSION_MAGIC = 0x52534350; // "PCSR"
+        constexpr std::uint32_t SESSION_VERSION = 1;
+
+        struct Header {
+            std::uint32_t magic = SESSION_MAGIC;
+            std::uint32_t version = SESSION_VERSION;
+            std::uint32_t inputSize = sizeof(SDL_Event);
+            std::uint32_t eventSize = sizeof(Event);
+            std::uint64_t seed = 0;
+        };
+
+        static_assert(std::is_trivially_copyable_v<SDL_Event>, "SDL_Event is written as raw bytes.");
+        static_assert(std::is_trivially_copyable_v<Header>, "Header is written as raw bytes.");
+
+        template<typename T>
+        void writeRaw(std::ofstream& stream, const T* values, std::size_t count) {
+            stream.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(sizeof(T) * count));
+        }
+
+        template<typename T>
+        bool readRaw(std::ifstream& stream, T* values, std::size_t count) {
+            stream.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(sizeof(T) * count));
+            return static_cast<std::size_t>(stream.gcount()) == sizeof(T) * count;
+        }
+    }
+
+    // 再生に必要な入力だけを残す（マウス・キーボード・ウィンドウ・終了）
+    inline bool isRecordedInput(const SDL_Event& event) {
+        switch (event.type) {
+            case SDL_QUIT:
+            case SDL_WINDOWEVENT:
+            case SDL_MOUSEMOTION:
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+            case SDL_MOUSEWHEEL:
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // フレームごとに入力・イベント・経過時間を書き出す
+    class SessionRecorder {
+    public:
+        bool open(const std::string& path, std::uint64_t seed) {
+            stream.open(path, std::ios::binary | std::ios::trunc);
+            if (!stream) {
+                return false;
+            }
+            detail::Header header;
+            header.seed = seed;
+            detail::writeRaw(stream, &header, 1);
+            return static_cast<bool>(stream);
+        }
+
+        bool isOpen() const {
+            return stream.is_open();
+        }
+
+        void beginFrame(float deltaTime) {
+            frame.clear();
+            frame.deltaTime = deltaTime;
+        }
+
+        void recordInput(const SDL_Event& event) {
+            if (isRecordedInput(event)) {
+                frame.inputs.push_back(event);
+            }
+        }
+
+        void recordEvent(const Event& event) {
+            frame.events.push_back(event);
+        }
+
+        void endFrame() {
+            auto inputCount = static_cast<std::uint32_t>(frame.inputs.size());
+            auto eventCount = static_cast<std::uint32_t>(frame.events.size());
+            detail::writeRaw(stream, &frame.deltaTime, 1);
+            detail::writeRaw(stream, &inputCount, 1);
+            detail::writeRaw(stream, &eventCount, 1);
+            detail::writeRaw(stream, frame.inputs.data(), frame.inputs.size());
+            detail::writeRaw(stream, frame.events.data(), frame.events.size());
+            ++frameCount;
+        }
+
+        std::size_t getFrameCount() const {
+            return frameCount;
+        }
+
+    private:
+        std::ofstream stream;
+        FrameRecord frame;
+        std::size_t frameCount = 0;
+    };
+
+    // 記録したフレームを順に読み出す
+    class SessionPlayer {
+    public:
+        // 形式やビルドが合わなければ false（error に理由）
+        bool open(const std::string& path) {
+            stream.open(path, std::ios::binary);
+            if (!stream) {
+                error = "cannot open file";
+                return false;
+            }
+            detail::Header header;
+            if (!detail::readRaw(stream, &header, 1) || header.magic != detail::SESSION_MAGIC) {
+                error = "not a session log";
+                return false;
+            }
+            if (header.version != detail::SESSION_VERSION || header.inputSize != sizeof(SDL_Event) ||
+                header.eventSize != sizeof(Event)) {
+                error = "session log was recorded by an incompatible build";
+                return false;
+            }
+            seed = header.seed;
+            return true;
+        }
+
+        // 次のフレームを読む。終わりか壊れていれば false
+        bool nextFrame(FrameRecord& frame) {
+            frame.clear();
+            std::uint32_t inputCount = 0;
+            std::uint32_t eventCount = 0;
+            if (!detail::readRaw(stream, &frame.deltaTime, 1) || !detail::readRaw(stream, &inputCount, 1) ||
+                !detail::readRaw(stream, &eventCount, 1)) {
+                return false;
+            }
+            frame.inputs.resize(inputCount);
+            frame.events.resize(eventCount);
+            if (!detail::readRaw(stream, frame.inputs.data(), inputCount) ||
+                !detail::readRaw(stream, frame.events.data(), eventCount)) {
+                return false;
+            }
+            ++frameCount;
+            return true;
+        }
+
+        std::uint64_t getSeed() const {
+            return seed;
+        }
+
+        std::size_t getFrameCount() const {
+            return frameCount;
+        }
+
+        const std::string& getError() const {
+            return error;
+        }
+
+    private:
+        std::ifstream stream;
+        std::uint64_t seed = 0;
+        std::size_t frameCount = 0;
+        std::string error;
+    };
+}
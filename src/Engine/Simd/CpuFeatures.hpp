@@ -0,0 +1,29 @@
+#pragma once
+
+namespace Simd {
+    // 実行中の CPU が使える命令セット（起動後に一度だけ調べる）
+    struct CpuFeatures {
+        bool avx2 = false;
+        bool neon = false;
+    };
+
+    namespace detail {
+        inline CpuFeatures detectCpuFeatures() {
+            CpuFeatures features;
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+            __builtin_cpu_init();
+            features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+            // AArch64 では NEON は必ず使える
+            features.neon = true;
+#endif
+            return features;
+        }
+    }
+
+    inline const CpuFeatures& cpuFeatures() {
+        static const CpuFeatures features = detail::detectCpuFeatures();
+        return features;
+    }
+}
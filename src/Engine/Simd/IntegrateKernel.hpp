@@ -0,0 +1,168 @@
+#pragma once
+
+#include "CpuFeatures.hpp"
+#include "../ECS/ComponentStorage.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SIMD_HAS_AVX2_KERNEL 1
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SIMD_HAS_NEON_KERNEL 1
+#endif
+
+namespace Simd {
+    // outOfBounds には (end - begin) + KERNEL_PADDING 要素以上の領域を渡すこと（圧縮書き込みがはみ出す分）
+    constexpr std::size_t KERNEL_PADDING = 8;
+
+    // positions += velocities * deltaTime を [begin, end) に行い、
+    // ±boundary の立方体から出た要素のインデックスを outOfBounds に詰めて、その個数を返す
+    using IntegrateFunc = std::size_t (*)(ECS::Float3Streams positions, ECS::Float3Streams velocities,
+                                          std::size_t begin, std::size_t end, float deltaTime, float boundary,
+                                          std::uint32_t* outOfBounds);
+
+    // 分岐なしで詰める。書き込みは毎回行い、領域外のときだけ書き込み位置を進める
+    inline std::size_t integrateScalar(ECS::Float3Streams positions, ECS::Float3Streams velocities,
+                                       std::size_t begin, std::size_t end, float deltaTime, float boundary,
+                                       std::uint32_t* outOfBounds) {
+        std::size_t count = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            float x = positions.x[i] + velocities.x[i] * deltaTime;
+            float y = positions.y[i] + velocities.y[i] * deltaTime;
+            float z = positions.z[i] + velocities.z[i] * deltaTime;
+            positions.x[i] = x;
+            positions.y[i] = y;
+            positions.z[i] = z;
+
+            bool outside = (x < -boundary) | (x > boundary) |
+                           (y < -boundary) | (y > boundary) |
+                           (z < -boundary) | (z > boundary);
+            outOfBounds[count] = static_cast<std::uint32_t>(i);
+            count += outside;
+        }
+        return count;
+    }
+
+#ifdef SIMD_HAS_AVX2_KERNEL
+    namespace detail {
+        // 8 レーンのマスクから、立っているレーン番号を前に詰めた並び（1 バイト × 8）
+        constexpr std::array<std::uint64_t, 256> makeCompressTable() {
+            std::array<std::uint64_t, 256> table{};
+            for (unsigned mask = 0; mask < 256; ++mask) {
+                std::uint64_t lanes = 0;
+                unsigned slot = 0;
+                for (unsigned lane = 0; lane < 8; ++lane) {
+                    if (mask & (1u << lane)) {
+                        lanes |= std::uint64_t{lane} << (8 * slot++);
+                    }
+                }
+                table[mask] = lanes;
+            }
+            return table;
+        }
+
+        inline constexpr std::array<std::uint64_t, 256> COMPRESS_TABLE = makeCompressTable();
+    }
+
+    // 8 要素ずつ積分と範囲判定を行い、領域外のレーンのインデックスを permute で前に詰めて書き出す
+    __attribute__((target("avx2")))
+    inline std::size_t integrateAvx2(ECS::Float3Streams positions, ECS::Float3Streams velocities,
+                                     std::size_t begin, std::size_t end, float deltaTime, float boundary,
+                                     std::uint32_t* outOfBounds) {
+        const __m256 dt = _mm256_set1_ps(deltaTime);
+        const __m256 upper = _mm256_set1_ps(boundary);
+        const __m256 lower = _mm256_set1_ps(-boundary);
+        const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        std::size_t count = 0;
+        std::size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 x = _mm256_add_ps(_mm256_loadu_ps(positions.x + i), _mm256_mul_ps(_mm256_loadu_ps(velocities.x + i), dt));
+            __m256 y = _mm256_add_ps(_mm256_loadu_ps(positions.y + i), _mm256_mul_ps(_mm256_loadu_ps(velocities.y + i), dt));
+            __m256 z = _mm256_add_ps(_mm256_loadu_ps(positions.z + i), _mm256_mul_ps(_mm256_loadu_ps(velocities.z + i), dt));
+            _mm256_storeu_ps(positions.x + i, x);
+            _mm256_storeu_ps(positions.y + i, y);
+            _mm256_storeu_ps(positions.z + i, z);
+
+            __m256 outside = _mm256_or_ps(
+                _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(x, lower, _CMP_LT_OQ), _mm256_cmp_ps(x, upper, _CMP_GT_OQ)),
+                             _mm256_or_ps(_mm256_cmp_ps(y, lower, _CMP_LT_OQ), _mm256_cmp_ps(y, upper, _CMP_GT_OQ))),
+                _mm256_or_ps(_mm256_cmp_ps(z, lower, _CMP_LT_OQ), _mm256_cmp_ps(z, upper, _CMP_GT_OQ)));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(outside));
+            if (mask != 0) {
+                __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), laneOffsets);
+                __m256i permutation = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&detail::COMPRESS_TABLE[mask])));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(outOfBounds + count),
+                                    _mm256_permutevar8x32_epi32(indices, permutation));
+                count += static_cast<std::size_t>(std::popcount(mask));
+            }
+        }
+
+        return count + integrateScalar(positions, velocities, i, end, deltaTime, boundary, outOfBounds + count);
+    }
+#endif
+
+#ifdef SIMD_HAS_NEON_KERNEL
+    // 4 要素ずつ積分と範囲判定を行う。NEON には圧縮命令が無いので、マスクのビットを順に拾って詰める
+    inline std::size_t integrateNeon(ECS::Float3Streams positions, ECS::Float3Streams velocities,
+                                     std::size_t begin, std::size_t end, float deltaTime, float boundary,
+                                     std::uint32_t* outOfBounds) {
+        const float32x4_t upper = vdupq_n_f32(boundary);
+        const float32x4_t lower = vdupq_n_f32(-boundary);
+        const uint32x4_t laneBits = {1, 2, 4, 8};
+
+        std::size_t count = 0;
+        std::size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            float32x4_t x = vmlaq_n_f32(vld1q_f32(positions.x + i), vld1q_f32(velocities.x + i), deltaTime);
+            float32x4_t y = vmlaq_n_f32(vld1q_f32(positions.y + i), vld1q_f32(velocities.y + i), deltaTime);
+            float32x4_t z = vmlaq_n_f32(vld1q_f32(positions.z + i), vld1q_f32(velocities.z + i), deltaTime);
+            vst1q_f32(positions.x + i, x);
+            vst1q_f32(positions.y + i, y);
+            vst1q_f32(positions.z + i, z);
+
+            uint32x4_t outside = vorrq_u32(
+                vorrq_u32(vorrq_u32(vcltq_f32(x, lower), vcgtq_f32(x, upper)),
+                          vorrq_u32(vcltq_f32(y, lower), vcgtq_f32(y, upper))),
+                vorrq_u32(vcltq_f32(z, lower), vcgtq_f32(z, upper)));
+            unsigned mask = vaddvq_u32(vandq_u32(outside, laneBits));
+            while (mask != 0) {
+                outOfBounds[count++] = static_cast<std::uint32_t>(i + std::countr_zero(mask));
+                mask &= mask - 1;
+            }
+        }
+
+        return count + integrateScalar(positions, velocities, i, end, deltaTime, boundary, outOfBounds + count);
+    }
+#endif
+
+    struct IntegrateKernel {
+        IntegrateFunc function;
+        const char* name;
+    };
+
+    // CPU に合わせた実装を一度だけ選ぶ
+    inline const IntegrateKernel& integrateKernel() {
+        static const IntegrateKernel kernel = []() {
+#ifdef SIMD_HAS_AVX2_KERNEL
+            if (cpuFeatures().avx2) {
+                return IntegrateKernel{&integrateAvx2, "AVX2"};
+            }
+#endif
+#ifdef SIMD_HAS_NEON_KERNEL
+            if (cpuFeatures().neon) {
+                return IntegrateKernel{&integrateNeon, "NEON"};
+            }
+#endif
+            return IntegrateKernel{&integrateScalar, "scalar"};
+        }();
+        return kernel;
+    }
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "CpuFeatures.hpp"
+#include "IntegrateKernel.hpp"
+#include "../ECS/ComponentStorage.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace Simd {
+    // ワールド座標からスクリーン座標への変換
+    // matrix は projection * view を掛け合わせた列優先の 4x4 行列（glm と同じ並び）
+    struct ScreenTransform {
+        float matrix[16];
+        float width;
+        float height;
+
+        // 1 点を NDC へ。w が 0 なら false
+        bool toNdc(float x, float y, float z, float& ndcX, float& ndcY, float& ndcZ) const {
+            float clipW;
+            return toNdc(x, y, z, ndcX, ndcY, ndcZ, clipW);
+        }
+
+        // clipW にはクリップ空間の w（透視投影ならカメラからの奥行き）を返す
+        bool toNdc(float x, float y, float z, float& ndcX, float& ndcY, float& ndcZ, float& clipW) const {
+            const float* m = matrix;
+            float clipX = m[0] * x + m[4] * y + m[8] * z + m[12];
+            float clipY = m[1] * x + m[5] * y + m[9] * z + m[13];
+            float clipZ = m[2] * x + m[6] * y + m[10] * z + m[14];
+            clipW = m[3] * x + m[7] * y + m[11] * z + m[15];
+            if (clipW == 0.0f) {
+                return false;
+            }
+            float inverseW = 1.0f / clipW;
+            ndcX = clipX * inverseW;
+            ndcY = clipY * inverseW;
+            ndcZ = clipZ * inverseW;
+            return true;
+        }
+
+        int toScreenX(float ndcX) const {
+            return static_cast<int>((ndcX + 1.0f) * 0.5f * width);
+        }
+
+        int toScreenY(float ndcY) const {
+            return static_cast<int>((1.0f - ndcY) * 0.5f * height); // Y軸反転
+        }
+    };
+
+    // 投影結果の書き出し先。どれも (end - begin) + KERNEL_PADDING 要素以上の領域を渡すこと
+    struct ScreenPoints {
+        std::uint32_t* indices; // 画面内に残った点の添字
+        std::int32_t* x;
+        std::int32_t* y;
+        float* depth;           // クリップ空間の w（奥行き。小さいほど手前）
+    };
+
+    // positions の [begin, end) を投影し、視錐台とウィンドウの内側に残った点だけを out に詰めて、その個数を返す
+    using ProjectFunc = std::size_t (*)(ECS::Float3Streams positions, std::size_t begin, std::size_t end,
+                                        const ScreenTransform& transform, ScreenPoints out);
+
+    inline std::size_t projectScalar(ECS::Float3Streams positions, std::size_t begin, std::size_t end,
+                                     const ScreenTransform& transform, ScreenPoints out) {
+        std::size_t count = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            float ndcX, ndcY, ndcZ, clipW;
+            if (!transform.toNdc(positions.x[i], positions.y[i], positions.z[i], ndcX, ndcY, ndcZ, clipW)) {
+                continue;
+            }
+            // NaN もここで落ちるよう、内側にあることを確かめる形で比べる
+            bool inside = (ndcX >= -1.0f) & (ndcX <= 1.0f) & (ndcY >= -1.0f) & (ndcY <= 1.0f) &
+                          (ndcZ >= -1.0f) & (ndcZ <= 1.0f);
+            if (!inside) {
+                continue;
+            }
+            int screenX = transform.toScreenX(ndcX);
+            int screenY = transform.toScreenY(ndcY);
+            if (screenX < 0 || screenX >= static_cast<int>(transform.width) ||
+                screenY < 0 || screenY >= static_cast<int>(transform.height)) {
+                continue;
+            }
+            out.indices[count] = static_cast<std::uint32_t>(i);
+            out.x[count] = screenX;
+            out.y[count] = screenY;
+            out.depth[count] = clipW;
+            ++count;
+        }
+        return count;
+    }
+
+#ifdef SIMD_HAS_AVX2_KERNEL
+    namespace detail {
+        // 行列の r 行目と (x, y, z, 1) の内積（スカラー版と同じ順に足す）
+        __attribute__((target("avx2")))
+        inline __m256 transformRow(const __m256* column, int r, __m256 x, __m256 y, __m256 z) {
+            return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(column[r], x), _mm256_mul_ps(column[4 + r], y)),
+                                               _mm256_mul_ps(column[8 + r], z)),
+                                 column[12 + r]);
+        }
+
+        // -1 <= v <= 1 のレーン（NaN は外）
+        __attribute__((target("avx2")))
+        inline __m256 withinUnit(__m256 v) {
+            return _mm256_and_ps(_mm256_cmp_ps(v, _mm256_set1_ps(-1.0f), _CMP_GE_OQ),
+                                 _mm256_cmp_ps(v, _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+        }
+    }
+
+    // 8 点ずつ行列を掛けて判定し、残ったレーンを IntegrateKernel と同じ並べ替え表で前に詰める
+    __attribute__((target("avx2")))
+    inline std::size_t projectAvx2(ECS::Float3Streams positions, std::size_t begin, std::size_t end,
+                                   const ScreenTransform& transform, ScreenPoints out) {
+        const float* m = transform.matrix;
+        __m256 column[16];
+        for (int k = 0; k < 16; ++k) {
+            column[k] = _mm256_set1_ps(m[k]);
+        }
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 width = _mm256_set1_ps(transform.width);
+        const __m256 height = _mm256_set1_ps(transform.height);
+        const __m256i widthLimit = _mm256_set1_epi32(static_cast<int>(transform.width));
+        const __m256i heightLimit = _mm256_set1_epi32(static_cast<int>(transform.height));
+        const __m256i negative = _mm256_set1_epi32(-1);
+        const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        std::size_t count = 0;
+        std::size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            __m256 x = _mm256_loadu_ps(positions.x + i);
+            __m256 y = _mm256_loadu_ps(positions.y + i);
+            __m256 z = _mm256_loadu_ps(positions.z + i);
+
+            // w が 0 のレーンは無限大か NaN になり、下の範囲判定で落ちる
+            __m256 clipW = detail::transformRow(column, 3, x, y, z);
+            __m256 inverseW = _mm256_div_ps(one, clipW);
+            __m256 ndcX = _mm256_mul_ps(detail::transformRow(column, 0, x, y, z), inverseW);
+            __m256 ndcY = _mm256_mul_ps(detail::transformRow(column, 1, x, y, z), inverseW);
+            __m256 ndcZ = _mm256_mul_ps(detail::transformRow(column, 2, x, y, z), inverseW);
+            __m256 inside = _mm256_and_ps(_mm256_and_ps(detail::withinUnit(ndcX), detail::withinUnit(ndcY)),
+                                          detail::withinUnit(ndcZ));
+
+            __m256i screenX = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(ndcX, one), half), width));
+            __m256i screenY = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(one, ndcY), half), height));
+            __m256i onScreen = _mm256_and_si256(
+                _mm256_and_si256(_mm256_cmpgt_epi32(screenX, negative), _mm256_cmpgt_epi32(widthLimit, screenX)),
+                _mm256_and_si256(_mm256_cmpgt_epi32(screenY, negative), _mm256_cmpgt_epi32(heightLimit, screenY)));
+
+            unsigned mask = static_cast<unsigned>(
+                _mm256_movemask_ps(_mm256_and_ps(inside, _mm256_castsi256_ps(onScreen))));
+            if (mask != 0) {
+                __m256i permutation = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&detail::COMPRESS_TABLE[mask])));
+                __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), laneOffsets);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.indices + count),
+                                    _mm256_permutevar8x32_epi32(indices, permutation));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.x + count),
+                                    _mm256_permutevar8x32_epi32(screenX, permutation));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.y + count),
+                                    _mm256_permutevar8x32_epi32(screenY, permutation));
+                _mm256_storeu_ps(out.depth + count, _mm256_permutevar8x32_ps(clipW, permutation));
+                count += static_cast<std::size_t>(std::popcount(mask));
+            }
+        }
+
+        ScreenPoints rest{out.indices + count, out.x + count, out.y + count, out.depth + count};
+        return count + projectScalar(positions, i, end, transform, rest);
+    }
+#endif
+
+#ifdef SIMD_HAS_NEON_KERNEL
+    // 4 点ずつ行列を掛けて判定し、マスクのビットを順に拾って詰める
+    inline std::size_t projectNeon(ECS::Float3Streams positions, std::size_t begin, std::size_t end,
+                                   const ScreenTransform& transform, ScreenPoints out) {
+        const float* m = transform.matrix;
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+        const int32x4_t widthLimit = vdupq_n_s32(static_cast<int>(transform.width));
+        const int32x4_t heightLimit = vdupq_n_s32(static_cast<int>(transform.height));
+        const int32x4_t zero = vdupq_n_s32(0);
+        const uint32x4_t laneBits = {1, 2, 4, 8};
+
+        auto row = [m](int r, float32x4_t x, float32x4_t y, float32x4_t z) {
+            return vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(x, m[r]), vmulq_n_f32(y, m[4 + r])),
+                                       vmulq_n_f32(z, m[8 + r])),
+                             vdupq_n_f32(m[12 + r]));
+        };
+        auto within = [&](float32x4_t v) {
+            return vandq_u32(vcgeq_f32(v, minusOne), vcleq_f32(v, one));
+        };
+
+        std::size_t count = 0;
+        std::size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            float32x4_t x = vld1q_f32(positions.x + i);
+            float32x4_t y = vld1q_f32(positions.y + i);
+            float32x4_t z = vld1q_f32(positions.z + i);
+
+            float32x4_t clipW = row(3, x, y, z);
+            float32x4_t inverseW = vdivq_f32(one, clipW);
+            float32x4_t ndcX = vmulq_f32(row(0, x, y, z), inverseW);
+            float32x4_t ndcY = vmulq_f32(row(1, x, y, z), inverseW);
+            float32x4_t ndcZ = vmulq_f32(row(2, x, y, z), inverseW);
+            uint32x4_t inside = vandq_u32(vandq_u32(within(ndcX), within(ndcY)), within(ndcZ));
+
+            int32x4_t screenX = vcvtq_s32_f32(vmulq_n_f32(vmulq_n_f32(vaddq_f32(ndcX, one), 0.5f), transform.width));
+            int32x4_t screenY = vcvtq_s32_f32(vmulq_n_f32(vmulq_n_f32(vsubq_f32(one, ndcY), 0.5f), transform.height));
+            uint32x4_t onScreen = vandq_u32(vandq_u32(vcgeq_s32(screenX, zero), vcltq_s32(screenX, widthLimit)),
+                                            vandq_u32(vcgeq_s32(screenY, zero), vcltq_s32(screenY, heightLimit)));
+
+            unsigned mask = vaddvq_u32(vandq_u32(vandq_u32(inside, onScreen), laneBits));
+            if (mask == 0) {
+                continue;
+            }
+            std::int32_t xs[4], ys[4];
+            float ws[4];
+            vst1q_s32(xs, screenX);
+            vst1q_s32(ys, screenY);
+            vst1q_f32(ws, clipW);
+            while (mask != 0) {
+                int lane = std::countr_zero(mask);
+                out.indices[count] = static_cast<std::uint32_t>(i + lane);
+                out.x[count] = xs[lane];
+                out.y[count] = ys[lane];
+                out.depth[count] = ws[lane];
+                ++count;
+                mask &= mask - 1;
+            }
+        }
+
+        ScreenPoints rest{out.indices + count, out.x + count, out.y + count, out.depth + count};
+        return count + projectScalar(positions, i, end, transform, rest);
+    }
+#endif
+
+    struct ProjectKernel {
+        ProjectFunc function;
+        const char* name;
+    };
+
+    // CPU に合わせた実装を一度だけ選ぶ
+    inline const ProjectKernel& projectKernel() {
+        static const ProjectKernel kernel = []() {
+#ifdef SIMD_HAS_AVX2_KERNEL
+            if (cpuFeatures().avx2) {
+                return ProjectKernel{&projectAvx2, "AVX2"};
+            }
+#endif
+#ifdef SIMD_HAS_NEON_KERNEL
+            if (cpuFeatures().neon) {
+                return ProjectKernel{&projectNeon, "NEON"};
+            }
+#endif
+            return ProjectKernel{&projectScalar, "scalar"};
+        }();
+        return kernel;
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ProjectKernel.hpp"
+#include "../Jobs/TaskGroup.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Simd {
+    // SoA の位置ストリームをまとめてスクリーン座標へ投影し、画面内に残った点だけを詰めて持つ段
+    // バッファはフレーム間で使い回す。結果は次の project() まで有効
+    class ScreenProjection {
+    public:
+        // positions の [0, count) を投影する。pool があれば chunkSize 件ずつワーカーに分ける
+        void project(ECS::Float3Streams positions, std::size_t count, const ScreenTransform& transform,
+                     Jobs::ThreadPool* pool = nullptr, std::size_t chunkSize = Jobs::DEFAULT_CHUNK_SIZE) {
+            const ProjectKernel& kernel = projectKernel();
+            chunkSize = std::max<std::size_t>(chunkSize, 1);
+
+            // 分割単位ごとに KERNEL_PADDING の余白を挟んだ領域へ書かせ、詰め書きのはみ出しが隣とぶつからないようにする
+            std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+            std::size_t capacity = count + chunks * KERNEL_PADDING;
+            indexBuffer.resize(capacity);
+            xBuffer.resize(capacity);
+            yBuffer.resize(capacity);
+            depthBuffer.resize(capacity);
+            chunkCounts.assign(chunks, 0);
+
+            // parallelFor は 0 から chunkSize の境目で分ける（分けずに全体を一度に渡すこともある）
+            auto projectRange = [&](std::size_t begin, std::size_t end) {
+                std::size_t chunk = begin / chunkSize;
+                std::size_t offset = begin + chunk * KERNEL_PADDING;
+                chunkCounts[chunk] = kernel.function(positions, begin, end, transform,
+                                                     ScreenPoints{indexBuffer.data() + offset, xBuffer.data() + offset,
+                                                                  yBuffer.data() + offset, depthBuffer.data() + offset});
+            };
+            if (pool) {
+                Jobs::parallelFor(*pool, 0, count, chunkSize, projectRange);
+            } else if (count > 0) {
+                projectRange(0, count);
+            }
+
+            // 分割単位ごとの結果を先頭から隙間なく並べ直す（書き込み先は常に読み出し元より前）
+            visibleCount = 0;
+            for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                std::size_t offset = chunk * (chunkSize + KERNEL_PADDING);
+                std::size_t n = chunkCounts[chunk];
+                if (offset != visibleCount) {
+                    std::copy_n(indexBuffer.begin() + offset, n, indexBuffer.begin() + visibleCount);
+                    std::copy_n(xBuffer.begin() + offset, n, xBuffer.begin() + visibleCount);
+                    std::copy_n(yBuffer.begin() + offset, n, yBuffer.begin() + visibleCount);
+                    std::copy_n(depthBuffer.begin() + offset, n, depthBuffer.begin() + visibleCount);
+                }
+                visibleCount += n;
+            }
+        }
+
+        // 画面内に残った点の数と、その添字・スクリーン座標・奥行き（添字の昇順）
+        std::size_t size() const {
+            return visibleCount;
+        }
+
+        const std::uint32_t* indices() const {
+            return indexBuffer.data();
+        }
+
+        const std::int32_t* screenX() const {
+            return xBuffer.data();
+        }
+
+        const std::int32_t* screenY() const {
+            return yBuffer.data();
+        }
+
+        const float* depth() const {
+            return depthBuffer.data();
+        }
+
+    private:
+        std::vector<std::uint32_t> indexBuffer{};
+        std::vector<std::int32_t> xBuffer{};
+        std::vector<std::int32_t> yBuffer{};
+        std::vector<float> depthBuffer{};
+        std::vector<std::size_t> chunkCounts{};
+        std::size_t visibleCount = 0;
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Spatial {
+    // 1軸あたりのビット数（3軸で 63 ビット）
+    constexpr int MORTON_BITS_PER_AXIS = 21;
+    constexpr std::uint32_t MORTON_AXIS_MAX = (1u << MORTON_BITS_PER_AXIS) - 1;
+
+    // 下位 21 ビットを 3 ビットおきに広げる（b20..b0 -> b60 0 0 b57 ... b3 0 0 b0）
+    inline std::uint64_t spreadBits3(std::uint32_t value) {
+        std::uint64_t x = value & MORTON_AXIS_MAX;
+        x = (x | (x << 32)) & 0x001F00000000FFFFull;
+        x = (x | (x << 16)) & 0x001F0000FF0000FFull;
+        x = (x | (x << 8)) & 0x100F00F00F00F00Full;
+        x = (x | (x << 4)) & 0x10C30C30C30C30C3ull;
+        x = (x | (x << 2)) & 0x1249249249249249ull;
+        return x;
+    }
+
+    // 量子化済みの3軸座標から Z 順序（Morton）の符号を作る
+    inline std::uint64_t mortonEncode3(std::uint32_t x, std::uint32_t y, std::uint32_t z) {
+        return spreadBits3(x) | (spreadBits3(y) << 1) | (spreadBits3(z) << 2);
+    }
+
+    // 軸に平行な範囲 [min, max] を 2^21 段階に量子化する
+    class MortonQuantizer {
+    public:
+        MortonQuantizer(float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+            : minX(minX), minY(minY), minZ(minZ),
+              scaleX(scaleFor(minX, maxX)), scaleY(scaleFor(minY, maxY)), scaleZ(scaleFor(minZ, maxZ)) {}
+
+        std::uint64_t encode(float x, float y, float z) const {
+            return mortonEncode3(quantize(x, minX, scaleX), quantize(y, minY, scaleY), quantize(z, minZ, scaleZ));
+        }
+
+    private:
+        float minX, minY, minZ;
+        float scaleX, scaleY, scaleZ;
+
+        static float scaleFor(float min, float max) {
+            float extent = max - min;
+            return extent > 0.0f ? static_cast<float>(MORTON_AXIS_MAX) / extent : 0.0f;
+        }
+
+        static std::uint32_t quantize(float value, float min, float scale) {
+            float q = (value - min) * scale;
+            // NaN も 0 に落とす
+            if (!(q > 0.0f)) {
+                return 0;
+            }
+            return static_cast<std::uint32_t>(std::min(q, static_cast<float>(MORTON_AXIS_MAX)));
+        }
+    };
+}
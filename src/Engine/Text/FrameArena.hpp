@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace Text {
+    // フレームごとに使い捨てる文字列の置き場
+    // 固定長のブロックを先頭から切り出し、reset() で巻き戻す。ブロックは解放せずに次のフレームで使い回すので、
+    // 使用量が落ち着けば確保は起きない。切り出した領域は reset() まで動かない
+    class FrameArena {
+    public:
+        static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+        char* allocate(std::size_t size) {
+            while (blockIndex < blocks.size() && used + size > blocks[blockIndex].size) {
+                ++blockIndex;
+                used = 0;
+            }
+            if (blockIndex == blocks.size()) {
+                std::size_t blockSize = std::max(size, BLOCK_SIZE);
+                blocks.push_back(Block{ std::make_unique<char[]>(blockSize), blockSize });
+                used = 0;
+            }
+            char* result = blocks[blockIndex].data.get() + used;
+            used += size;
+            return result;
+        }
+
+        void reset() {
+            blockIndex = 0;
+            used = 0;
+        }
+
+    private:
+        struct Block {
+            std::unique_ptr<char[]> data;
+            std::size_t size;
+        };
+
+        std::vector<Block> blocks{};
+        std::size_t blockIndex = 0;
+        std::size_t used = 0;
+    };
+
+    // "(x, y, z)" を小数点以下 6 桁（std::to_string と同じ）で arena に書く
+    inline std::string_view formatCoordinates(FrameArena& arena, float x, float y, float z) {
+        // 符号・整数部・小数部が float の最大値でも収まる大きさ
+        constexpr std::size_t MAX_NUMBER = 48;
+        constexpr std::size_t MAX_LENGTH = 3 * MAX_NUMBER + 6;
+        char* begin = arena.allocate(MAX_LENGTH);
+        char* end = begin + MAX_LENGTH;
+        char* cursor = begin;
+
+        const float values[3] = { x, y, z };
+        *cursor++ = '(';
+        for (int i = 0; i < 3; ++i) {
+            if (i > 0) {
+                *cursor++ = ',';
+                *cursor++ = ' ';
+            }
+            auto result = std::to_chars(cursor, end, values[i], std::chars_format::fixed, 6);
+            cursor = result.ec == std::errc{} ? result.ptr : cursor;
+        }
+        *cursor++ = ')';
+        return std::string_view(begin, static_cast<std::size_t>(cursor - begin));
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace Text {
+    // 印字可能な ASCII の字形を一度だけラスタライズして一枚のテクスチャに並べたもの
+    // 字形は白で描いてあるので、頂点色を掛けて好きな色で使える
+    // テクスチャはレンダラーのものなので、レンダラーを破棄する前に release() を呼ぶこと
+    class GlyphAtlas {
+    public:
+        static constexpr char FIRST_CHAR = ' ';
+        static constexpr char LAST_CHAR = '~';
+        // 字形を並べるテクスチャの幅（高さは字形の数に合わせる）
+        static constexpr int ATLAS_WIDTH = 512;
+
+        struct Glyph {
+            SDL_Rect source; // テクスチャ上の範囲（行の高さぶん。ベースラインは揃っている）
+            int advance;     // 次の文字までの送り幅
+        };
+
+        GlyphAtlas() = default;
+        ~GlyphAtlas() {
+            release();
+        }
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        // フォントを開いて字形を並べ、テクスチャを作る。フォントは作り終えたら閉じる
+        bool load(SDL_Renderer* renderer, const std::string& fontPath, int fontSize) {
+            release();
+            TTF_Font* font = TTF_OpenFont(fontPath.c_str(), fontSize);
+            if (!font) {
+                SDL_Log("Failed to load font %s: %s", fontPath.c_str(), TTF_GetError());
+                return false;
+            }
+            bool built = build(renderer, font);
+            TTF_CloseFont(font);
+            return built;
+        }
+
+        void release() {
+            if (texture) {
+                SDL_DestroyTexture(texture);
+                texture = nullptr;
+            }
+        }
+
+        bool isLoaded() const {
+            return texture != nullptr;
+        }
+
+        SDL_Texture* getTexture() const {
+            return texture;
+        }
+
+        int getWidth() const {
+            return width;
+        }
+
+        int getHeight() const {
+            return height;
+        }
+
+        int getLineHeight() const {
+            return lineHeight;
+        }
+
+        // 範囲外の文字は '?' で代用する
+        const Glyph& glyph(char c) const {
+            if (c < FIRST_CHAR || c > LAST_CHAR) {
+                c = '?';
+            }
+            return glyphs[static_cast<std::size_t>(c - FIRST_CHAR)];
+        }
+
+        int textWidth(std::string_view text) const {
+            int total = 0;
+            for (char c : text) {
+                total += glyph(c).advance;
+            }
+            return total;
+        }
+
+    private:
+        static constexpr std::size_t GLYPH_COUNT = static_cast<std::size_t>(LAST_CHAR - FIRST_CHAR + 1);
+        // 字形どうしのにじみを防ぐ隙間
+        static constexpr int PADDING = 1;
+
+        SDL_Texture* texture = nullptr;
+        int width = 0;
+        int height = 0;
+        int lineHeight = 0;
+        std::array<Glyph, GLYPH_COUNT> glyphs{};
+
+        bool build(SDL_Renderer* renderer, TTF_Font* font) {
+            const SDL_Color white = { 255, 255, 255, 255 };
+            std::array<SDL_Surface*, GLYPH_COUNT> surfaces{};
+            lineHeight = TTF_FontHeight(font);
+
+            // 左から詰めて、幅を超えたら次の行へ
+            int penX = PADDING;
+            int penY = PADDING;
+            int rowHeight = 0;
+            for (std::size_t i = 0; i < GLYPH_COUNT; ++i) {
+                auto code = static_cast<Uint16>(FIRST_CHAR + static_cast<char>(i));
+                int advance = 0;
+                if (TTF_GlyphMetrics(font, code, nullptr, nullptr, nullptr, nullptr, &advance) != 0) {
+                    advance = 0;
+                }
+                // 空白は面を持たないことがある
+                SDL_Surface* surface = code == ' ' ? nullptr : TTF_RenderGlyph_Blended(font, code, white);
+                surfaces[i] = surface;
+                int w = surface ? surface->w : 0;
+                int h = surface ? surface->h : 0;
+                if (penX + w + PADDING > ATLAS_WIDTH) {
+                    penX = PADDING;
+                    penY += rowHeight + PADDING;
+                    rowHeight = 0;
+                }
+                glyphs[i] = Glyph{ SDL_Rect{ penX, penY, w, h }, advance };
+                penX += w + PADDING;
+                rowHeight = std::max(rowHeight, h);
+            }
+            width = ATLAS_WIDTH;
+            height = penY + rowHeight + PADDING;
+
+            SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+            bool ok = atlas != nullptr;
+            if (!ok) {
+                SDL_Log("Failed to create glyph atlas surface: %s", SDL_GetError());
+            }
+            for (std::size_t i = 0; i < GLYPH_COUNT; ++i) {
+                if (!surfaces[i]) {
+                    continue;
+                }
+                if (ok) {
+                    // アルファをそのまま写す
+                    SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+                    SDL_Rect destination = glyphs[i].source;
+                    SDL_BlitSurface(surfaces[i], nullptr, atlas, &destination);
+                }
+                SDL_FreeSurface(surfaces[i]);
+            }
+            if (!ok) {
+                return false;
+            }
+
+            texture = SDL_CreateTextureFromSurface(renderer, atlas);
+            SDL_FreeSurface(atlas);
+            if (!texture) {
+                SDL_Log("Failed to create glyph atlas texture: %s", SDL_GetError());
+                return false;
+            }
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            return true;
+        }
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Text {
+    // 画面上のラベルの配置を決める段
+    // 候補を優先度（小さいほど優先。例: カメラからの奥行き）の順に見て、既に置いたラベルと重ならないものだけを
+    // 最大 budget 個まで選ぶ。重なりは画面を CELL_SIZE 四方に区切った占有グリッドで調べる
+    // 候補の走査は軽い比較だけで、文字列の組み立てや重なりの判定は上位の一定数にしか行わないので、
+    // ラベルにかかる処理は点群の大きさによらず抑えられる
+    class LabelPlacer {
+    public:
+        static constexpr int CELL_SIZE = 8;
+        // 重なりで落ちる分を見込んで、budget のこの倍数までの候補を順に試す
+        static constexpr std::size_t OVERSAMPLE = 4;
+
+        struct Rect {
+            int x, y, w, h;
+        };
+
+        explicit LabelPlacer(std::size_t budget = 64) : budget(budget) {}
+
+        void setBudget(std::size_t maxLabels) {
+            budget = maxLabels;
+        }
+
+        std::size_t getBudget() const {
+            return budget;
+        }
+
+        // keys[0, count) を優先度として候補を選ぶ
+        // rectOf(i) は候補 i のラベルの画面上の範囲を返し、accept(i) は置くと決めた候補ごとに優先度の順で呼ばれる
+        // rectOf(i) の直後に同じ i で accept(i) が呼ばれるので、rectOf で作った文字列をそのまま使ってよい
+        template<typename RectOf, typename Accept>
+        std::size_t place(int screenWidth, int screenHeight, const float* keys, std::size_t count,
+                          RectOf&& rectOf, Accept&& accept) {
+            if (budget == 0 || count == 0 || screenWidth <= 0 || screenHeight <= 0) {
+                return 0;
+            }
+            beginFrame(screenWidth, screenHeight);
+            selectBest(keys, count, budget * OVERSAMPLE);
+
+            std::size_t placed = 0;
+            for (std::uint32_t candidate : best) {
+                if (tryOccupy(rectOf(static_cast<std::size_t>(candidate)))) {
+                    accept(static_cast<std::size_t>(candidate));
+                    if (++placed == budget) {
+                        break;
+                    }
+                }
+            }
+            return placed;
+        }
+
+    private:
+        std::size_t budget;
+        int columns = 0;
+        int rows = 0;
+        // 占有グリッド。今のフレームの番号が入っていれば埋まっている（毎フレーム消さずに番号を進める）
+        std::vector<std::uint32_t> cells{};
+        std::uint32_t frame = 0;
+        // 優先度の高い順に並べた候補
+        std::vector<std::uint32_t> best{};
+
+        void beginFrame(int screenWidth, int screenHeight) {
+            int newColumns = (screenWidth + CELL_SIZE - 1) / CELL_SIZE;
+            int newRows = (screenHeight + CELL_SIZE - 1) / CELL_SIZE;
+            if (newColumns != columns || newRows != rows || ++frame == 0) {
+                columns = newColumns;
+                rows = newRows;
+                cells.assign(static_cast<std::size_t>(columns) * rows, 0);
+                frame = 1;
+            }
+        }
+
+        // 上位 limit 件を、大きさ limit のヒープ（先頭が最も劣る候補）を保ちながら一度の走査で集める
+        // 同じ優先度なら添字の小さい方を先にするので、結果は一意に決まる
+        void selectBest(const float* keys, std::size_t count, std::size_t limit) {
+            auto better = [keys](std::uint32_t a, std::uint32_t b) {
+                return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+            };
+            best.clear();
+            for (std::size_t i = 0; i < count; ++i) {
+                auto candidate = static_cast<std::uint32_t>(i);
+                if (!(keys[i] == keys[i])) {
+                    continue; // NaN は並べられない
+                }
+                if (best.size() < limit) {
+                    best.push_back(candidate);
+                    std::push_heap(best.begin(), best.end(), better);
+                } else if (better(candidate, best.front())) {
+                    std::pop_heap(best.begin(), best.end(), better);
+                    best.back() = candidate;
+                    std::push_heap(best.begin(), best.end(), better);
+                }
+            }
+            std::sort_heap(best.begin(), best.end(), better);
+        }
+
+        // 画面からはみ出す分は切り取って調べる。空いていれば埋めて true
+        bool tryOccupy(const Rect& rect) {
+            int left = std::max(rect.x, 0) / CELL_SIZE;
+            int top = std::max(rect.y, 0) / CELL_SIZE;
+            int right = std::min(rect.x + rect.w, columns * CELL_SIZE);
+            int bottom = std::min(rect.y + rect.h, rows * CELL_SIZE);
+            if (rect.w <= 0 || rect.h <= 0 || right <= std::max(rect.x, 0) || bottom <= std::max(rect.y, 0)) {
+                return false;
+            }
+            right = (right - 1) / CELL_SIZE;
+            bottom = (bottom - 1) / CELL_SIZE;
+
+            for (int row = top; row <= bottom; ++row) {
+                const std::uint32_t* line = cells.data() + static_cast<std::size_t>(row) * columns;
+                for (int column = left; column <= right; ++column) {
+                    if (line[column] == frame) {
+                        return false;
+                    }
+                }
+            }
+            for (int row = top; row <= bottom; ++row) {
+                std::uint32_t* line = cells.data() + static_cast<std::size_t>(row) * columns;
+                std::fill(line + left, line + right + 1, frame);
+            }
+            return true;
+        }
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "GlyphAtlas.hpp"
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace Text {
+    // 文字列を字形の四角形として頂点バッファに溜め、一度の SDL_RenderGeometry でまとめて描く
+    // バッファはフレーム間で使い回す
+    class TextBatch {
+    public:
+        void clear() {
+            vertices.clear();
+            quadCount = 0;
+        }
+
+        bool empty() const {
+            return quadCount == 0;
+        }
+
+        // 左上を (x, y) として text を置く
+        void add(const GlyphAtlas& atlas, std::string_view text, int x, int y, SDL_Color color) {
+            float inverseWidth = 1.0f / static_cast<float>(atlas.getWidth());
+            float inverseHeight = 1.0f / static_cast<float>(atlas.getHeight());
+            int penX = x;
+            for (char c : text) {
+                const GlyphAtlas::Glyph& glyph = atlas.glyph(c);
+                const SDL_Rect& source = glyph.source;
+                if (source.w > 0 && source.h > 0) {
+                    float left = static_cast<float>(penX);
+                    float top = static_cast<float>(y);
+                    float right = left + static_cast<float>(source.w);
+                    float bottom = top + static_cast<float>(source.h);
+                    float u0 = static_cast<float>(source.x) * inverseWidth;
+                    float v0 = static_cast<float>(source.y) * inverseHeight;
+                    float u1 = static_cast<float>(source.x + source.w) * inverseWidth;
+                    float v1 = static_cast<float>(source.y + source.h) * inverseHeight;
+                    vertices.push_back(SDL_Vertex{ SDL_FPoint{left, top}, color, SDL_FPoint{u0, v0} });
+                    vertices.push_back(SDL_Vertex{ SDL_FPoint{right, top}, color, SDL_FPoint{u1, v0} });
+                    vertices.push_back(SDL_Vertex{ SDL_FPoint{right, bottom}, color, SDL_FPoint{u1, v1} });
+                    vertices.push_back(SDL_Vertex{ SDL_FPoint{left, bottom}, color, SDL_FPoint{u0, v1} });
+                    ++quadCount;
+                }
+                penX += glyph.advance;
+            }
+        }
+
+        // 溜めた四角形を描いて空にする
+        void flush(SDL_Renderer* renderer, const GlyphAtlas& atlas) {
+            if (quadCount == 0) {
+                return;
+            }
+            // 添字は四角形の並びによらず同じ形なので、足りなくなったときだけ伸ばす
+            for (std::size_t k = indices.size() / 6; k < quadCount; ++k) {
+                int base = static_cast<int>(k * 4);
+                indices.insert(indices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
+            }
+            if (SDL_RenderGeometry(renderer, atlas.getTexture(), vertices.data(), static_cast<int>(vertices.size()),
+                                   indices.data(), static_cast<int>(quadCount * 6)) != 0) {
+                SDL_Log("SDL_RenderGeometry failed: %s", SDL_GetError());
+            }
+            clear();
+        }
+
+    private:
+        std::vector<SDL_Vertex> vertices{};
+        std::vector<int> indices{};
+        std::size_t quadCount = 0;
+    };
+}
@@ -4,6 +4,8 @@
 #include "../Engine/ECS/Coordinator.hpp"
 #include "../Components/CameraComponent.hpp"
 #include "../Components/ProjectionComponent.hpp"
+#include "../Engine/Events/EventManager.hpp"
+#include "../Engine/Simd/ProjectKernel.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <SDL2/SDL.h>
@@ -13,6 +15,7 @@ class CameraSystem : public ECS::System {
 public:
     CameraSystem()
         : coordinator(nullptr),
+          eventManager(nullptr),
           windowWidth(800),
           windowHeight(600),
           dragging(false),
@@ -26,6 +29,11 @@ public:
         coordinator = coord;
     }
 
+    // 設定されていれば、マウス操作を CameraOrbit イベントとして送り、フレームごとにまとめて反映する
+    void setEventManager(EventManager* manager) {
+        eventManager = manager;
+    }
+
     void setWindowSize(int width, int height) {
         windowWidth = width;
         windowHeight = height;
@@ -55,59 +63,49 @@ public:
                 lastMouseY = event.motion.y;
 
                 float sensitivity = 0.005f;
-                float deltaYaw = dx * sensitivity;
-                float deltaPitch = dy * sensitivity;
-
-                for (auto const& entity : entities) {
-                    if (coordinator->hasComponent<CameraComponent>(entity)) {
-                        auto& camera = coordinator->getComponent<CameraComponent>(entity);
-                        camera.yaw += deltaYaw;
-                        camera.pitch += deltaPitch;
-
-                        // ピッチの制限（上下方向の回転を制限）
-                        if (camera.pitch > glm::radians(89.0f)) camera.pitch = glm::radians(89.0f);
-                        if (camera.pitch < glm::radians(-89.0f)) camera.pitch = glm::radians(-89.0f);
-
-                        // カメラの位置を再計算（オービットカメラとして）
-                        updateCameraPosition(camera);
-
-                        SDL_Log("Camera updated: yaw=%.2f, pitch=%.2f, position=(%.2f, %.2f, %.2f)",
-                                camera.yaw, camera.pitch, camera.position.x, camera.position.y, camera.position.z);
-                    }
-                }
+                requestOrbit(CameraOrbitPayload{dx * sensitivity, dy * sensitivity, 0.0f});
             }
         }
         else if (event.type == SDL_MOUSEWHEEL) {
             // マウスホイールのスクロールによるカメラのズーム
             // event.wheel.y > 0: scroll up, event.wheel.y < 0: scroll down
             float zoomSensitivity = 1.0f; // 調整可能
-            float deltaRadius = event.wheel.y * zoomSensitivity;
-            float newRadius = cameraRadius - deltaRadius; // スクロールアップでズームイン（半径を減らす）
-
-            // 最小・最大半径の設定
-            const float minRadius = 5.0f;
-            const float maxRadius = 100.0f;
-
-            // クランプ
-            if (newRadius < minRadius) newRadius = minRadius;
-            if (newRadius > maxRadius) newRadius = maxRadius;
-
-            if (newRadius != cameraRadius) {
-                cameraRadius = newRadius;
-
-                // カメラの位置を再計算（オービットカメラとして）
-                for (auto const& entity : entities) {
-                    if (coordinator->hasComponent<CameraComponent>(entity)) {
-                        auto& camera = coordinator->getComponent<CameraComponent>(entity);
-                        updateCameraPosition(camera);
-                        SDL_Log("Camera radius updated: %.2f, new position=(%.2f, %.2f, %.2f)",
-                                cameraRadius, camera.position.x, camera.position.y, camera.position.z);
-                    }
-                }
-            }
+            // スクロールアップでズームイン（半径を減らす）
+            requestOrbit(CameraOrbitPayload{0.0f, 0.0f, -event.wheel.y * zoomSensitivity});
         }
     }
 
+    // 回転とズームを反映してカメラ位置を計算し直す
+    void orbit(const CameraOrbitPayload& delta) {
+        // 最小・最大半径の設定
+        const float minRadius = 5.0f;
+        const float maxRadius = 100.0f;
+        float newRadius = cameraRadius + delta.deltaRadius;
+        if (newRadius < minRadius) newRadius = minRadius;
+        if (newRadius > maxRadius) newRadius = maxRadius;
+
+        if (delta.deltaYaw == 0.0f && delta.deltaPitch == 0.0f && newRadius == cameraRadius) {
+            return;
+        }
+        cameraRadius = newRadius;
+
+        coordinator->view<CameraComponent>().each([&](CameraComponent& camera) {
+            camera.yaw += delta.deltaYaw;
+            camera.pitch += delta.deltaPitch;
+
+            // ピッチの制限（上下方向の回転を制限）
+            if (camera.pitch > glm::radians(89.0f)) camera.pitch = glm::radians(89.0f);
+            if (camera.pitch < glm::radians(-89.0f)) camera.pitch = glm::radians(-89.0f);
+
+            // カメラの位置を再計算（オービットカメラとして）
+            updateCameraPosition(camera);
+
+            SDL_Log("Camera updated: yaw=%.2f, pitch=%.2f, radius=%.2f, position=(%.2f, %.2f, %.2f)",
+                    camera.yaw, camera.pitch, cameraRadius, camera.position.x, camera.position.y, camera.position.z);
+        });
+        coordinator->markAllChanged<CameraComponent>();
+    }
+
     // カメラ行列の計算
     glm::mat4 getViewMatrix() const {
         for (auto const& entity : entities) {
@@ -135,8 +133,23 @@ public:
         return glm::mat4(1.0f);
     }
 
+    // 投影行列とカメラ行列を一度だけ掛け合わせた、width x height の画面への変換
+    Simd::ScreenTransform getScreenTransform(int width, int height) const {
+        glm::mat4 viewProjection = getProjectionMatrix() * getViewMatrix();
+        Simd::ScreenTransform transform{};
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                transform.matrix[column * 4 + row] = viewProjection[column][row];
+            }
+        }
+        transform.width = static_cast<float>(width);
+        transform.height = static_cast<float>(height);
+        return transform;
+    }
+
 private:
     ECS::Coordinator* coordinator;
+    EventManager* eventManager;
     int windowWidth;
     int windowHeight;
     bool dragging;
@@ -144,6 +157,13 @@ private:
     int lastMouseY;
     float cameraRadius; // カメラと原点の距離
 
+    void requestOrbit(const CameraOrbitPayload& delta) {
+        if (eventManager && eventManager->sendEvent(Event{Event::CameraOrbit, delta})) {
+            return;
+        }
+        orbit(delta);
+    }
+
     // カメラの位置を更新する関数
     void updateCameraPosition(CameraComponent& camera) const {
         // 球面座標からデカルト座標への変換
@@ -4,59 +4,47 @@
 #include "../Engine/ECS/Coordinator.hpp"
 #include "../Components/MorphingComponent.hpp"
 #include "../Components/PositionComponent.hpp"
+#include "../Engine/Events/TimerWheel.hpp"
 #include <glm/glm.hpp>
 #include <SDL2/SDL.h>
 #include <vector>
 
 class MorphingSystem : public ECS::System {
 public:
-    MorphingSystem() : coordinator(nullptr) {}
+    MorphingSystem() : coordinator(nullptr), clock(nullptr) {}
     ~MorphingSystem() {}
 
     void setCoordinator(ECS::Coordinator* coord) {
         coordinator = coord;
     }
 
-    void update(float deltaTime)  {
-        if (!coordinator) {
-            SDL_Log("MorphingSystem: Coordinator is null.");
+    // 進み具合は共有の時計からの経過で決める（エンティティごとに経過時間を数えない）
+    // 完了したモーフの後始末は、開始した側が同じ時計に予約したタイマーでまとめて行う
+    void setClock(const TimerWheel* timerWheel) {
+        clock = timerWheel;
+    }
+
+    void update(float /*deltaTime*/)  {
+        if (!coordinator || !clock) {
+            SDL_Log("MorphingSystem: Coordinator or clock is null.");
             return;
         }
 
-        std::vector<ECS::Entity> completedEntities;
-
-        // 反復処理中にコレクションを変更しない
-        for (auto const& entity : entities) {
-            if (coordinator->hasComponent<MorphingComponent>(entity) &&
-                coordinator->hasComponent<PositionComponent>(entity)) {
+        double now = clock->getTime();
+        coordinator->query<MorphingComponent, PositionComponent>().each(
+            [&](ECS::Entity entity, MorphingComponent& morph, ECS::ComponentRef<PositionComponent> positionComponent) {
+                auto& position = positionComponent.position;
 
-                auto& morph = coordinator->getComponent<MorphingComponent>(entity);
-                auto& position = coordinator->getComponent<PositionComponent>(entity).position;
-
-                morph.elapsed += deltaTime;
-                float t = morph.elapsed / morph.duration;
+                float t = static_cast<float>((now - morph.startTime) / morph.duration);
                 if (t > 1.0f) t = 1.0f;
 
                 // 線形補間
                 position = glm::mix(morph.startPosition, morph.targetPosition, t);
-
-                SDL_Log("Entity %d: Morphing t=%.2f, Position=(%.2f, %.2f, %.2f)",
-                        entity, t, position.x, position.y, position.z);
-
-                if (t >= 1.0f) {
-                    // モーフィングが完了したエンティティをリストに追加
-                    completedEntities.push_back(entity);
-                }
-            }
-        }
-
-        // 反復処理後に MorphingComponent を削除
-        for (auto const& entity : completedEntities) {
-            coordinator->removeComponent<MorphingComponent>(entity);
-            SDL_Log("Morphing complete for entity %d.", entity);
-        }
+                coordinator->markChanged<PositionComponent>(entity);
+            });
     }
 
 private:
     ECS::Coordinator* coordinator;
+    const TimerWheel* clock;
 };
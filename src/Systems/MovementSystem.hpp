@@ -3,57 +3,217 @@
 
 #include "../Engine/ECS/System.hpp"
 #include "../Engine/ECS/Coordinator.hpp"
+#include "../Engine/Jobs/TaskGroup.hpp"
+#include "../Engine/Simd/IntegrateKernel.hpp"
 #include "../Components/PositionComponent.hpp"
 #include "../Components/VelocityComponent.hpp"
+#include "ParticleEmitter.hpp"
 #include <glm/glm.hpp>
 #include <SDL2/SDL.h>
-#include <vector> // 追加: std::vector を使用するため
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
 
 class MovementSystem : public ECS::System {
 public:
-    MovementSystem() : coordinator(nullptr) {}
+    // 領域外に出た点の扱い
+    enum class BoundaryMode {
+        Destroy, // エンティティを破棄する
+        Recycle  // エミッタの分布で位置と速度を初期化し直し、その場で再利用する（構造変更なし）
+    };
+
+    MovementSystem() : coordinator(nullptr), threadPool(nullptr), chunkSize(Jobs::DEFAULT_CHUNK_SIZE) {
+        setRandomSeed(std::random_device{}());
+    }
     ~MovementSystem() {}
 
     void setCoordinator(ECS::Coordinator* coord) {
         coordinator = coord;
     }
 
+    // 設定されていれば積分をワーカーに分割して実行する
+    void setThreadPool(Jobs::ThreadPool* pool) {
+        threadPool = pool;
+    }
+
+    void setChunkSize(std::size_t size) {
+        chunkSize = size;
+    }
+
+    void setBoundaryMode(BoundaryMode mode) {
+        boundaryMode = mode;
+    }
+
+    void setEmitter(const ParticleEmitter& newEmitter) {
+        emitter = newEmitter;
+    }
+
+    // 維持したい点の数（0 なら制限なし）
+    // Recycle では、予算を超えている分は再利用せずに破棄し、足りない分は emissionRate で補充する
+    void setParticleBudget(std::size_t budget) {
+        particleBudget = budget;
+    }
+
+    // 予算に満たないときに 1 秒あたり補充する点の数（0 以下なら一度に補充する）
+    void setEmissionRate(float particlesPerSecond) {
+        emissionRate = particlesPerSecond;
+    }
+
+    // 再出現・補充の乱数の種。同じ種と同じ入力なら、スレッド数や処理順によらず同じ結果になる
+    void setRandomSeed(std::uint64_t seed) {
+        randomSeed = seed;
+        emitEngine.seed(static_cast<std::uint32_t>(mixSeed(seed, 0, 0)));
+    }
+
     void update(float deltaTime) {
         if (!coordinator) {
             SDL_Log("MovementSystem: Coordinator is null.");
             return;
         }
+        ++frameIndex;
+
+        // 両方の配列の先頭に対象エンティティを同じ順序で集め、成分ごとの配列をそのまま処理する
+        auto view = coordinator->view<PositionComponent, VelocityComponent>();
+        std::size_t count = view.pack();
+        ECS::Float3Streams positions = view.streams<PositionComponent>();
+        ECS::Float3Streams velocities = view.streams<VelocityComponent>();
+        const ECS::Entity* entities = view.packedEntities();
 
-        // 削除対象のエンティティを収集するリスト
-        std::vector<ECS::Entity> toDelete;
+        // 積分と範囲判定は CPU に合わせて選んだ SIMD カーネルで行い、領域外の添字だけを分割単位ごとに受け取る
+        // 破棄か再利用かはこの後メインスレッドでまとめて決めるので、結果はワーカー数や処理順によらない
+        const Simd::IntegrateKernel& kernel = Simd::integrateKernel();
+        std::size_t chunk = std::max<std::size_t>(chunkSize, 1);
+        outOfBoundsChunks.resize(std::max<std::size_t>((count + chunk - 1) / chunk, 1));
+        auto integrate = [&](std::size_t begin, std::size_t end) {
+            // 領域外に出たか確認（例: ±10ユニットの立方体）
+            float boundary = 10.0f;
+            // parallelFor は 0 から chunkSize の境目で分ける（分けずに全体を一度に渡すこともある）
+            OutOfBounds& outOfBounds = outOfBoundsChunks[begin / chunk];
+            outOfBounds.indices.resize(end - begin + Simd::KERNEL_PADDING);
+            outOfBounds.count = kernel.function(positions, velocities, begin, end, deltaTime, boundary,
+                                                outOfBounds.indices.data());
+        };
+        for (OutOfBounds& outOfBounds : outOfBoundsChunks) {
+            outOfBounds.count = 0;
+        }
+        if (threadPool) {
+            Jobs::parallelFor(*threadPool, 0, count, chunkSize, integrate);
+        } else if (count > 0) {
+            integrate(0, count);
+        }
 
-        for (auto const& entity : entities) {
-            if (coordinator->hasComponent<PositionComponent>(entity) &&
-                coordinator->hasComponent<VelocityComponent>(entity)) {
+        // 位置は全点を書き換えたので配列単位で変更を記録する
+        if (count > 0) {
+            coordinator->markAllChanged<PositionComponent>();
+        }
 
-                auto& position = coordinator->getComponent<PositionComponent>(entity).position;
-                auto& velocity = coordinator->getComponent<VelocityComponent>(entity).velocity;
+        // 領域外に出たエンティティの破棄はコマンドバッファへ記録し、同期点でまとめて行う
+        // 予算を超えている分は、領域外に出た点のうちエンティティの値が小さいものから再利用せずに破棄する
+        // 配列の並びは空間整列（別スレッドの整列が終わったフレーム）で変わるので、添字ではなくエンティティで選ぶ
+        auto& commands = coordinator->commands();
+        escapees.clear();
+        for (const OutOfBounds& outOfBounds : outOfBoundsChunks) {
+            escapees.insert(escapees.end(), outOfBounds.indices.begin(),
+                            outOfBounds.indices.begin() + static_cast<std::ptrdiff_t>(outOfBounds.count));
+        }
+        std::size_t destroyed = escapees.size();
+        if (boundaryMode == BoundaryMode::Recycle) {
+            std::size_t excess = particleBudget > 0 && count > particleBudget ? count - particleBudget : 0;
+            destroyed = std::min(excess, escapees.size());
+        }
+        auto byEntity = [entities](std::uint32_t a, std::uint32_t b) { return entities[a] < entities[b]; };
+        auto destroyEnd = escapees.begin() + static_cast<std::ptrdiff_t>(destroyed);
+        if (destroyed > 0 && destroyed < escapees.size()) {
+            std::nth_element(escapees.begin(), destroyEnd, escapees.end(), byEntity);
+        }
+        std::sort(escapees.begin(), destroyEnd, byEntity);
 
-                // 位置を更新
-                position += velocity * deltaTime;
+        for (auto it = escapees.begin(); it != destroyEnd; ++it) {
+            commands.destroyEntity(entities[*it]);
+        }
+        for (auto it = destroyEnd; it != escapees.end(); ++it) {
+            respawn(positions, velocities, *it, entities[*it]);
+            coordinator->markChanged<VelocityComponent>(entities[*it]);
+        }
 
-                // 領域外に出たか確認（例: ±10ユニットの立方体）
-                float boundary = 10.0f;
-                if (position.x < -boundary || position.x > boundary ||
-                    position.y < -boundary || position.y > boundary ||
-                    position.z < -boundary || position.z > boundary) {
-                    toDelete.push_back(entity);
-                }
-            }
+        if (destroyed > 0) {
+            SDL_Log("MovementSystem: %zu entities deleted for moving out of bounds.", destroyed);
         }
 
-        // 削除対象のエンティティを削除
-        for (auto const& entity : toDelete) {
-            coordinator->destroyEntity(entity);
-            SDL_Log("Entity %d deleted for moving out of bounds.", entity);
+        if (boundaryMode == BoundaryMode::Recycle) {
+            emit(commands, count, deltaTime);
         }
     }
 
 private:
     ECS::Coordinator* coordinator;
+    Jobs::ThreadPool* threadPool;
+    std::size_t chunkSize;
+    BoundaryMode boundaryMode = BoundaryMode::Destroy;
+    ParticleEmitter emitter{};
+    std::size_t particleBudget = 0;
+    float emissionRate = 0.0f;
+    float emissionAccumulator = 0.0f;
+    std::uint64_t randomSeed = 0;
+    std::uint64_t frameIndex = 0;
+    // 補充はメインスレッドの1か所だけなので、エンジンを1つ持ち回る
+    std::minstd_rand emitEngine;
+
+    // 分割単位ごとの、領域外に出た点の添字（フレーム間で使い回す）
+    struct OutOfBounds {
+        std::vector<std::uint32_t> indices;
+        std::size_t count = 0;
+    };
+    std::vector<OutOfBounds> outOfBoundsChunks;
+    // このフレームに領域外に出た点の添字（破棄する分を先頭に並べ替える）
+    std::vector<std::uint32_t> escapees;
+
+    // 種・フレーム・エンティティから乱数列の初期値を作る（SplitMix64 の混ぜ方）
+    static std::uint64_t mixSeed(std::uint64_t seed, std::uint64_t frame, std::uint64_t entity) {
+        std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * (frame * 0x100000001B3ull + entity + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // どのワーカーが処理しても同じ値になるよう、乱数はエンティティごとに作る
+    void respawn(const ECS::Float3Streams& positions, const ECS::Float3Streams& velocities, std::size_t index,
+                 ECS::Entity entity) const {
+        std::minstd_rand engine(static_cast<std::uint32_t>(mixSeed(randomSeed, frameIndex, entity)));
+        glm::vec3 position;
+        glm::vec3 velocity;
+        emitter.sample(engine, position, velocity);
+        positions.x[index] = position.x;
+        positions.y[index] = position.y;
+        positions.z[index] = position.z;
+        velocities.x[index] = velocity.x;
+        velocities.y[index] = velocity.y;
+        velocities.z[index] = velocity.z;
+    }
+
+    // 予算に足りない分を emissionRate に従って新しく生成する（反映は同期点）
+    void emit(ECS::CommandBuffer& commands, std::size_t liveCount, float deltaTime) {
+        if (particleBudget == 0 || liveCount >= particleBudget) {
+            emissionAccumulator = 0.0f;
+            return;
+        }
+
+        std::size_t missing = particleBudget - liveCount;
+        std::size_t spawnCount = missing;
+        if (emissionRate > 0.0f) {
+            emissionAccumulator += emissionRate * deltaTime;
+            spawnCount = std::min(missing, static_cast<std::size_t>(emissionAccumulator));
+            emissionAccumulator -= static_cast<float>(spawnCount);
+        }
+
+        for (std::size_t i = 0; i < spawnCount; ++i) {
+            glm::vec3 position;
+            glm::vec3 velocity;
+            emitter.sample(emitEngine, position, velocity);
+            ECS::PendingEntity entity = commands.createEntity();
+            commands.addComponent(entity, PositionComponent{position});
+            commands.addComponent(entity, VelocityComponent{velocity});
+        }
+    }
 };
@@ -0,0 +1,38 @@
+// src/Systems/ParticleEmitter.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <random>
+
+// 点を（再）出現させるときの位置と初速の分布
+struct ParticleEmitter {
+    enum class Shape {
+        Box,    // center ± extent の直方体内で一様
+        Sphere  // center を中心とする半径 extent.x の球内で一様
+    };
+
+    Shape shape = Shape::Box;
+    glm::vec3 center{0.0f, 0.0f, 0.0f};
+    glm::vec3 extent{5.0f, 5.0f, 5.0f};
+    // 初速は baseVelocity ± velocityExtent の範囲で一様
+    glm::vec3 baseVelocity{0.0f, 0.0f, 0.0f};
+    glm::vec3 velocityExtent{0.05f, 0.05f, 0.05f};
+
+    template<typename Rng>
+    void sample(Rng& rng, glm::vec3& position, glm::vec3& velocity) const {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        glm::vec3 offset(unit(rng), unit(rng), unit(rng));
+        if (shape == Shape::Sphere) {
+            // 棄却法で単位球内の点を選ぶ
+            while (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z > 1.0f) {
+                offset = glm::vec3(unit(rng), unit(rng), unit(rng));
+            }
+            position = center + offset * extent.x;
+        } else {
+            position = center + offset * extent;
+        }
+
+        velocity = baseVelocity + glm::vec3(unit(rng), unit(rng), unit(rng)) * velocityExtent;
+    }
+};
@@ -7,21 +7,34 @@
 #include "../Components/MorphingComponent.hpp"
 #include "../Components/WaveletVisualizationComponent.hpp"
 #include "CameraSystem.hpp"
+#include "../Engine/Jobs/TaskGroup.hpp"
+#include "../Engine/Simd/ScreenProjection.hpp"
+#include "../Engine/Text/GlyphAtlas.hpp"
+#include "../Engine/Text/TextBatch.hpp"
+#include "../Engine/Text/FrameArena.hpp"
+#include "../Engine/Text/LabelPlacer.hpp"
+#include "../Engine/Raster/TiledRasterizer.hpp"
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <unordered_set>
 #include <vector>
 
 class RenderSystem : public ECS::System {
 public:
+    // 点群の描き方
+    enum class Backend {
+        SdlRenderer, // SDL_Renderer の矩形としてまとめて送る
+        Software     // CPU でタイルごとに並列にラスタライズし（奥行き比較・遠近で大きさが変わる円）、テクスチャで貼る
+    };
+
     RenderSystem() : coordinator(nullptr), renderer(nullptr), windowWidth(800), windowHeight(600), cameraSystem(nullptr),
-    font(nullptr)
+    glyphAtlas(nullptr), threadPool(nullptr), chunkSize(Jobs::DEFAULT_CHUNK_SIZE)
     {}
     ~RenderSystem() {
-        if (font) {
-            TTF_CloseFont(font);
-            font = nullptr;
+        if (pointTexture) {
+            SDL_DestroyTexture(pointTexture);
+            pointTexture = nullptr;
         }
     }
 
@@ -36,80 +49,136 @@ public:
     void setWindowSize(int width, int height) {
         windowWidth = width;
         windowHeight = height;
+        viewportChanged = true;
     }
 
     void setCameraSystem(CameraSystem* camSys) {
         cameraSystem = camSys;
     }
 
-    bool loadFont(const std::string& fontPath, int fontSize) {
-        font = TTF_OpenFont(fontPath.c_str(), fontSize);
-        if (!font) {
-            SDL_Log("Failed to load font %s: %s", fontPath.c_str(), TTF_GetError());
-            return false;
-        }
-        return true;
+    // 設定されていれば投影をワーカーに分割して実行する
+    void setThreadPool(Jobs::ThreadPool* pool) {
+        threadPool = pool;
     }
 
-    void update(float deltaTime) {
-        if (!renderer || !coordinator || !cameraSystem) {
-            SDL_Log("RenderSystem: Missing renderer, coordinator, or cameraSystem.");
-            return;
-        }
-
-        // カメラ行列と投影行列の取得
-        glm::mat4 view = cameraSystem->getViewMatrix();
-        glm::mat4 projection = cameraSystem->getProjectionMatrix();
-
-        // 点群の描画
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // 白
-        int drawableEntities = 0; // 描画対象のエンティティ数
-        int loggedPoints = 0; // ログ出力した点の数
-        for (auto const& entity : entities) {
-            if (!coordinator->hasComponent<PositionComponent>(entity))
-                continue;
-
-            drawableEntities++;
+    void setChunkSize(std::size_t size) {
+        chunkSize = size;
+    }
 
-            auto& position = coordinator->getComponent<PositionComponent>(entity).position;
+    void setBackend(Backend newBackend) {
+        backend = newBackend;
+        viewportChanged = true; // 描き方に合わせたバッファを作り直す
+    }
 
-            // ワールド座標からクリップ空間へ
-            glm::vec4 clipSpacePos = projection * view * glm::vec4(position, 1.0f);
+    // Software で描く点の、ワールド座標での半径
+    void setSplatRadius(float radius) {
+        splatRadius = radius;
+        rasterDirty = true;
+    }
 
-            // NDC（Normalized Device Coordinates）に変換
-            if (clipSpacePos.w == 0.0f) continue; // ゼロ除算を避ける
-            glm::vec3 ndc = glm::vec3(clipSpacePos) / clipSpacePos.w;
+    // 座標ラベルの字形（main で一度だけ作り、システム間で共有する）
+    void setGlyphAtlas(const Text::GlyphAtlas* atlas) {
+        glyphAtlas = atlas;
+    }
 
-            // スクリーン座標に変換
-            int screenX = static_cast<int>((ndc.x + 1.0f) * 0.5f * windowWidth);
-            int screenY = static_cast<int>((1.0f - ndc.y) * 0.5f * windowHeight); // Y軸反転
+    // 1 フレームに置く座標ラベルの上限
+    void setLabelBudget(std::size_t maxLabels) {
+        labelPlacer.setBudget(maxLabels);
+    }
 
-            // 視野外の点を描画しない
-            if (ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f || ndc.z < -1.0f || ndc.z > 1.0f)
-                continue;
+    // 距離によらず優先してラベルを付けるエンティティ
+    void setLabelSelection(const std::vector<ECS::Entity>& selection) {
+        selectedEntities.clear();
+        selectedEntities.insert(selection.begin(), selection.end());
+    }
 
-            // スクリーン座標がウィンドウ内か確認
-            if (screenX < 0 || screenX >= windowWidth || screenY < 0 || screenY >= windowHeight)
-                continue;
+    void update(float deltaTime) {
+        if (!renderer || !coordinator || !cameraSystem) {
+            SDL_Log("RenderSystem: Missing renderer, coordinator, or cameraSystem.");
+            return;
+        }
 
-            // 特定のエンティティID（例: 0）に対してスクリーン座標をログ出力
-            if (entity == 0 && loggedPoints < 5) { // 最初の5点のみログ
-                SDL_Log("Entity %d: Screen Position = (%d, %d)", entity, screenX, screenY);
-                loggedPoints++;
+        // 投影行列とカメラ行列は一度だけ掛け合わせ、全点で同じ変換を使う
+        Simd::ScreenTransform transform = cameraSystem->getScreenTransform(windowWidth, windowHeight);
+
+        // 前回の投影以降に何も変わっていなければ、前回の結果をそのまま描く
+        // カメラ・画面サイズ・点の並び・位置のどれかが変わったら全点をまとめて投影し直す
+        ECS::ChangeTick since = lastProjectedTick;
+        lastProjectedTick = coordinator->advanceChangeTick();
+
+        auto pointView = coordinator->view<PositionComponent>();
+        std::size_t pointCount = pointView.sizeHint();
+        ECS::Float3Streams positions = pointView.streams<PositionComponent>();
+        const ECS::Entity* entities = pointView.packedEntities();
+        bool reproject = viewportChanged || projectedCount != pointCount ||
+                         coordinator->structureChangedSince<PositionComponent>(since) ||
+                         coordinator->anyChangedSince<PositionComponent>(since) ||
+                         coordinator->anyChangedSince<CameraComponent>(since) ||
+                         coordinator->anyChangedSince<ProjectionComponent>(since);
+        viewportChanged = false;
+
+        // SoA の位置ストリームを SIMD でまとめて投影する（ワーカーがあれば分割して並列に）
+        if (reproject) {
+            screenPoints.project(positions, pointCount, transform, threadPool, chunkSize);
+            projectedCount = pointCount;
+
+            // 描画用の矩形もここで作り直す（容量はフレーム間で使い回すので再確保は増えたときだけ）
+            pointRects.resize(backend == Backend::SdlRenderer ? screenPoints.size() : 0);
+            for (std::size_t k = 0; k < pointRects.size(); ++k) {
+                pointRects[k] = SDL_Rect{ screenPoints.screenX()[k], screenPoints.screenY()[k], 2, 2 };
             }
+        }
 
-            // 小さな矩形としてポイントを描画
-            SDL_Rect pointRect = { screenX, screenY, 2, 2 };
-            if (SDL_RenderFillRect(renderer, &pointRect) != 0) {
-                SDL_Log("SDL_RenderFillRect failed: %s", SDL_GetError());
+        // 点群の描画（レンダラーはメインスレッドからのみ触る）
+        if (backend == Backend::Software) {
+            drawSoftware(reproject);
+        } else {
+            // 点はすべて同じ色なので、点の数によらず一度の呼び出しでまとめて送る
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // 白
+            if (!pointRects.empty() &&
+                SDL_RenderFillRects(renderer, pointRects.data(), static_cast<int>(pointRects.size())) != 0) {
+                SDL_Log("SDL_RenderFillRects failed: %s", SDL_GetError());
             }
-            renderCoordinateLabel(position, screenX, screenY);
         }
 
-        SDL_Log("RenderSystem: Drawable Entities = %d", drawableEntities);
+        const std::uint32_t* indices = screenPoints.indices();
+        const std::int32_t* screenX = screenPoints.screenX();
+        const std::int32_t* screenY = screenPoints.screenY();
+
+        // 座標ラベルは選択中の点を優先し、あとはカメラに近い順に、重ならないものを上限（setLabelBudget）まで置く
+        // 字形の四角形として溜めて最後にまとめて描く（文字列はフレーム用の領域に書く）
+        if (glyphAtlas) {
+            const float* labelKeys = screenPoints.depth();
+            if (!selectedEntities.empty()) {
+                selectionKeys.assign(labelKeys, labelKeys + screenPoints.size());
+                for (std::size_t k = 0; k < selectionKeys.size(); ++k) {
+                    if (selectedEntities.count(entities[indices[k]]) > 0) {
+                        selectionKeys[k] = -1.0f; // 奥行きは正なので、選択中の点が必ず先に来る
+                    }
+                }
+                labelKeys = selectionKeys.data();
+            }
+
+            labelArena.reset();
+            int lineHeight = glyphAtlas->getLineHeight();
+            std::string_view text;
+            labelPlacer.place(windowWidth, windowHeight, labelKeys, screenPoints.size(),
+                [&](std::size_t k) {
+                    std::uint32_t index = indices[k];
+                    text = Text::formatCoordinates(labelArena, positions.x[index], positions.y[index], positions.z[index]);
+                    // 点の右上に表示
+                    return Text::LabelPlacer::Rect{ screenX[k] + 5, screenY[k] - lineHeight - 5,
+                                                    glyphAtlas->textWidth(text), lineHeight };
+                },
+                [&](std::size_t k) {
+                    labelBatch.add(*glyphAtlas, text, screenX[k] + 5, screenY[k] - lineHeight - 5,
+                                   SDL_Color{ 255, 255, 255, 255 });
+                });
+            labelBatch.flush(renderer, *glyphAtlas);
+        }
 
         // 座標軸の描画
-        drawAxes(view, projection);
+        drawAxes(transform);
     }
 
 private:
@@ -118,78 +187,93 @@ private:
     int windowWidth;
     int windowHeight;
     CameraSystem* cameraSystem; // CameraSystem のポインタ
-    TTF_Font* font;
-
-    void renderCoordinateLabel(const glm::vec3& position, int screenX, int screenY) {
-        if (!font) return;
-
-        // テキスト内容を作成
-        std::string text = "(" + std::to_string(position.x) + ", " +
-                            std::to_string(position.y) + ", " +
-                            std::to_string(position.z) + ")";
-
-        // テキストをサーフェスにレンダリング
-        SDL_Color textColor = { 255, 255, 255, 255 }; // 白色
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, text.c_str(), textColor);
-        if (!textSurface) {
-            SDL_Log("Failed to render text surface: %s", TTF_GetError());
-            return;
+    const Text::GlyphAtlas* glyphAtlas;
+    Jobs::ThreadPool* threadPool;
+    std::size_t chunkSize;
+    // 画面内に残った点の添字とスクリーン座標（変更が無ければフレーム間で使い回す）
+    Simd::ScreenProjection screenPoints;
+    std::size_t projectedCount = 0;
+    // 画面内の点の矩形（SDL_RenderFillRects にまとめて渡す）
+    std::vector<SDL_Rect> pointRects;
+    Backend backend = Backend::SdlRenderer;
+    // Software の描画先。点の無い画素は透明にして、先に描かれたものに重ねる
+    Raster::TiledRasterizer rasterizer;
+    SDL_Texture* pointTexture = nullptr;
+    float splatRadius = 0.03f;
+    bool rasterDirty = true;
+    // 座標ラベルの頂点と文字列（フレーム間で使い回す）
+    Text::TextBatch labelBatch;
+    Text::FrameArena labelArena;
+    Text::LabelPlacer labelPlacer;
+    std::unordered_set<ECS::Entity> selectedEntities;
+    // 選択中の点を先にするために書き換えた優先度（選択があるときだけ使う）
+    std::vector<float> selectionKeys;
+    // 最後に投影したときの変更追跡の時刻
+    ECS::ChangeTick lastProjectedTick = 0;
+    bool viewportChanged = true;
+
+    // 投影し直したときだけラスタライズしてテクスチャを書き換え、毎フレーム一枚のテクスチャとして貼る
+    void drawSoftware(bool reprojected) {
+        if (!pointTexture || rasterizer.getWidth() != windowWidth || rasterizer.getHeight() != windowHeight) {
+            if (pointTexture) {
+                SDL_DestroyTexture(pointTexture);
+            }
+            pointTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                             windowWidth, windowHeight);
+            if (!pointTexture) {
+                SDL_Log("Failed to create point texture: %s", SDL_GetError());
+                return;
+            }
+            SDL_SetTextureBlendMode(pointTexture, SDL_BLENDMODE_BLEND);
+            rasterizer.resize(windowWidth, windowHeight);
+            rasterDirty = true;
         }
 
-        // サーフェスをテクスチャに変換
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        if (!textTexture) {
-            SDL_Log("Failed to create text texture: %s", SDL_GetError());
-            SDL_FreeSurface(textSurface);
-            return;
+        if (reprojected || rasterDirty) {
+            void* pixels = nullptr;
+            int pitch = 0;
+            if (SDL_LockTexture(pointTexture, nullptr, &pixels, &pitch) != 0) {
+                SDL_Log("SDL_LockTexture failed: %s", SDL_GetError());
+                return;
+            }
+            // 半径 splatRadius の球が奥行き w で画面上に占める半径は splatRadius * (画面の高さ / 2) * P[1][1] / w
+            float focalPixels = 0.5f * static_cast<float>(windowHeight) * cameraSystem->getProjectionMatrix()[1][1];
+            rasterizer.render(screenPoints, splatRadius * focalPixels, 0xFFFFFFFFu, 0x00000000u, pixels, pitch,
+                              threadPool);
+            SDL_UnlockTexture(pointTexture);
+            rasterDirty = false;
         }
 
-        // テクスチャのサイズを取得
-        int textWidth = textSurface->w;
-        int textHeight = textSurface->h;
-
-        // テクスチャの描画位置を設定（点の右下に表示）
-        SDL_Rect renderQuad = { screenX + 5, screenY - textHeight - 5, textWidth, textHeight };
-
-        // テクスチャをレンダラーにコピー
-        if (SDL_RenderCopy(renderer, textTexture, NULL, &renderQuad) != 0) {
-            SDL_Log("Failed to render text texture: %s", SDL_GetError());
+        if (SDL_RenderCopy(renderer, pointTexture, nullptr, nullptr) != 0) {
+            SDL_Log("Failed to render point texture: %s", SDL_GetError());
         }
-
-        // リソースの解放
-        SDL_DestroyTexture(textTexture);
-        SDL_FreeSurface(textSurface);
     }
 
-    void drawAxes(const glm::mat4& view, const glm::mat4& projection) {
+
+    void drawAxes(const Simd::ScreenTransform& transform) {
         // X軸（赤）、Y軸（緑）、Z軸（青）
         struct Axis {
-            glm::vec3 start;
             glm::vec3 end;
             SDL_Color color;
         };
 
-        std::vector<Axis> axes = {
-            { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(10.0f, 0.0f, 0.0f), SDL_Color{255, 0, 0, 255} }, // X軸
-            { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 10.0f, 0.0f), SDL_Color{0, 255, 0, 255} }, // Y軸
-            { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 10.0f), SDL_Color{0, 0, 255, 255} }  // Z軸
+        const Axis axes[] = {
+            { glm::vec3(10.0f, 0.0f, 0.0f), SDL_Color{255, 0, 0, 255} }, // X軸
+            { glm::vec3(0.0f, 10.0f, 0.0f), SDL_Color{0, 255, 0, 255} }, // Y軸
+            { glm::vec3(0.0f, 0.0f, 10.0f), SDL_Color{0, 0, 255, 255} }  // Z軸
         };
 
-        for (auto& axis : axes) {
-            // ワールド座標からクリップ空間へ
-            glm::vec4 startClip = projection * view * glm::vec4(axis.start, 1.0f);
-            glm::vec4 endClip = projection * view * glm::vec4(axis.end, 1.0f);
-
-            // NDCに変換
-            if (startClip.w == 0.0f || endClip.w == 0.0f) continue;
-            glm::vec3 startNDC = glm::vec3(startClip) / startClip.w;
-            glm::vec3 endNDC = glm::vec3(endClip) / endClip.w;
-
-            // スクリーン座標に変換
-            int startX = static_cast<int>((startNDC.x + 1.0f) * 0.5f * windowWidth);
-            int startY = static_cast<int>((1.0f - startNDC.y) * 0.5f * windowHeight);
-            int endX = static_cast<int>((endNDC.x + 1.0f) * 0.5f * windowWidth);
-            int endY = static_cast<int>((1.0f - endNDC.y) * 0.5f * windowHeight);
+        // 線は画面外にはみ出しても SDL が切り取るので、点群と違って視野外の判定はしない
+        float originX, originY, originZ;
+        if (!transform.toNdc(0.0f, 0.0f, 0.0f, originX, originY, originZ)) return;
+        int startX = transform.toScreenX(originX);
+        int startY = transform.toScreenY(originY);
+
+        for (const auto& axis : axes) {
+            float ndcX, ndcY, ndcZ;
+            if (!transform.toNdc(axis.end.x, axis.end.y, axis.end.z, ndcX, ndcY, ndcZ)) continue;
+            int endX = transform.toScreenX(ndcX);
+            int endY = transform.toScreenY(ndcY);
 
             // 線を描画
             SDL_SetRenderDrawColor(renderer, axis.color.r, axis.color.g, axis.color.b, axis.color.a);
@@ -0,0 +1,149 @@
+// src/Systems/SpatialSortSystem.hpp
+#pragma once
+
+#include "../Engine/ECS/System.hpp"
+#include "../Engine/ECS/Coordinator.hpp"
+#include "../Engine/Spatial/Morton.hpp"
+#include "../Components/PositionComponent.hpp"
+#include "../Components/VelocityComponent.hpp"
+#include "../Components/MorphingComponent.hpp"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 点の密配列を位置の Morton 符号（Z 順序）で並べ替え、空間的に近い点をメモリ上でも近くに置く
+// 1. 位置と ID を写し取り、符号の計算と整列は専用のスレッドで行う（その間もフレームは進む）
+//    共有のスレッドプールには積まない。parallelFor の wait() は待つ間にプールのどのジョブでも手伝うので、
+//    整列のような長いジョブがあると、メインスレッドや他のシステムのワーカーがそれを拾ってフレームが止まる
+// 2. 整列が終わったら、Position / Velocity / Morphing の配列を毎フレーム少しずつ同じ順に並べ替える
+// 写し取った後に動いた点の分だけ並びは古くなるので、requestSort() を定期的に呼んで保つ
+class SpatialSortSystem : public ECS::System {
+public:
+    SpatialSortSystem() : coordinator(nullptr) {}
+    ~SpatialSortSystem() {
+        // 実行中の整列を待つ
+        if (sortThread.joinable()) {
+            sortThread.join();
+        }
+    }
+
+    void setCoordinator(ECS::Coordinator* coord) {
+        coordinator = coord;
+    }
+
+    // 1 フレームで配置するエンティティ数の上限
+    void setPlacementsPerFrame(std::size_t count) {
+        placementsPerFrame = std::max<std::size_t>(count, 1);
+    }
+
+    // 次の update で並べ替えを始める（実行中なら終わった後）
+    void requestSort() {
+        requested = true;
+    }
+
+    void update(float /*deltaTime*/) {
+        if (!coordinator) {
+            SDL_Log("SpatialSortSystem: Coordinator is null.");
+            return;
+        }
+
+        if (state == State::Sorting) {
+            if (!sortFinished.load(std::memory_order_acquire)) {
+                return;
+            }
+            sortThread.join();
+            reorder = coordinator->reorder<PositionComponent, VelocityComponent, MorphingComponent>(std::move(sortedEntities));
+            sortedEntities = {};
+            state = State::Applying;
+        }
+
+        if (state == State::Applying) {
+            if (reorder.step(placementsPerFrame)) {
+                SDL_Log("SpatialSortSystem: reordered %zu points by Morton code.", reorder.size());
+                reorder = {};
+                state = State::Idle;
+            }
+            return;
+        }
+
+        if (!requested) {
+            return;
+        }
+        requested = false;
+        startSort();
+    }
+
+private:
+    enum class State {
+        Idle,     // 次の並べ替えを待っている
+        Sorting,  // 専用のスレッドで符号を計算して整列している
+        Applying  // 整列済みの順に配列を並べ替えている
+    };
+
+    struct Snapshot {
+        std::vector<ECS::Entity> entities;
+        std::vector<float> xs;
+        std::vector<float> ys;
+        std::vector<float> zs;
+    };
+
+    ECS::Coordinator* coordinator;
+    std::size_t placementsPerFrame = 16384;
+    bool requested = false;
+    State state = State::Idle;
+    std::atomic<bool> sortFinished{false};
+    // 整列のスレッドが書き、sortFinished を見てから読む
+    std::vector<ECS::Entity> sortedEntities;
+    ECS::Reorder reorder;
+    std::thread sortThread;
+
+    void startSort() {
+        // 写し取りだけはここで行う（この間は他のシステムが配列を触らない）
+        auto pointView = coordinator->view<PositionComponent>();
+        std::size_t count = pointView.sizeHint();
+        if (count < 2) {
+            return;
+        }
+        ECS::Float3Streams positions = pointView.streams<PositionComponent>();
+        const ECS::Entity* entities = pointView.packedEntities();
+
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->entities.assign(entities, entities + count);
+        snapshot->xs.assign(positions.x, positions.x + count);
+        snapshot->ys.assign(positions.y, positions.y + count);
+        snapshot->zs.assign(positions.z, positions.z + count);
+
+        state = State::Sorting;
+        sortFinished.store(false, std::memory_order_relaxed);
+        sortThread = std::thread([this, snapshot]() {
+            sortedEntities = sortByMorton(*snapshot);
+            sortFinished.store(true, std::memory_order_release);
+        });
+    }
+
+    // 点群の外接箱で量子化した Morton 符号の昇順に ID を並べる
+    static std::vector<ECS::Entity> sortByMorton(const Snapshot& snapshot) {
+        std::size_t count = snapshot.entities.size();
+        auto [minX, maxX] = std::minmax_element(snapshot.xs.begin(), snapshot.xs.end());
+        auto [minY, maxY] = std::minmax_element(snapshot.ys.begin(), snapshot.ys.end());
+        auto [minZ, maxZ] = std::minmax_element(snapshot.zs.begin(), snapshot.zs.end());
+        Spatial::MortonQuantizer quantizer(*minX, *minY, *minZ, *maxX, *maxY, *maxZ);
+
+        std::vector<std::pair<std::uint64_t, ECS::Entity>> keyed(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            keyed[i] = {quantizer.encode(snapshot.xs[i], snapshot.ys[i], snapshot.zs[i]), snapshot.entities[i]};
+        }
+        std::sort(keyed.begin(), keyed.end());
+
+        std::vector<ECS::Entity> order(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            order[i] = keyed[i].second;
+        }
+        return order;
+    }
+};
@@ -105,6 +105,7 @@ public:
         // AudioComponent のサンプルデータを更新
         auto& audio = coordinator->getComponent<AudioComponent>(entity);
         audio.samples = approx;
+        coordinator->markChanged<AudioComponent>(entity);
 
         SDL_Log("Inverse wavelet transform performed on entity %d.", entity);
     }
@@ -6,8 +6,12 @@
 #include "../Engine/ECS/Coordinator.hpp"
 #include "../Components/WaveletVisualizationComponent.hpp"
 #include "CameraSystem.hpp"
+#include "../Engine/Simd/ScreenProjection.hpp"
+#include "../Engine/Text/GlyphAtlas.hpp"
+#include "../Engine/Text/TextBatch.hpp"
+#include "../Engine/Text/FrameArena.hpp"
+#include "../Engine/Text/LabelPlacer.hpp"
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
@@ -20,17 +24,10 @@ public:
           windowWidth(800),
           windowHeight(600),
           cameraSystem(nullptr),
-          font(nullptr),
+          glyphAtlas(nullptr),
           amplitudeThreshold(0.5f) // 初期値
     {}
 
-    ~WaveletVisualizationSystem() {
-        if (font) {
-            TTF_CloseFont(font);
-            font = nullptr;
-        }
-    }
-
     void setCoordinator(ECS::Coordinator* coord) {
         coordinator = coord;
     }
@@ -42,25 +39,27 @@ public:
     void setWindowSize(int width, int height) {
         windowWidth = width;
         windowHeight = height;
+        projectionDirty = true;
     }
 
     void setCameraSystem(CameraSystem* camSys) {
         cameraSystem = camSys;
     }
 
-    // フォントをロードするメソッドを追加
-    bool loadFont(const std::string& fontPath, int fontSize) {
-        font = TTF_OpenFont(fontPath.c_str(), fontSize);
-        if (!font) {
-            SDL_Log("Failed to load font %s: %s", fontPath.c_str(), TTF_GetError());
-            return false;
-        }
-        return true;
+    // 座標ラベルの字形（main で一度だけ作り、システム間で共有する）
+    void setGlyphAtlas(const Text::GlyphAtlas* atlas) {
+        glyphAtlas = atlas;
+    }
+
+    // 1 フレームに置く座標ラベルの上限
+    void setLabelBudget(std::size_t maxLabels) {
+        labelPlacer.setBudget(maxLabels);
     }
 
     // 振幅閾値を設定するメソッド
     void setAmplitudeThreshold(float threshold) {
         amplitudeThreshold = threshold;
+        projectionDirty = true;
     }
 
     void update(float deltaTime) {
@@ -69,62 +68,45 @@ public:
             return;
         }
 
-        if (!font) {
-            SDL_Log("WaveletVisualizationSystem: Font not loaded.");
+        if (!glyphAtlas) {
+            SDL_Log("WaveletVisualizationSystem: Glyph atlas not set.");
             return;
         }
 
-        // カメラ行列と投影行列の取得
-        glm::mat4 view = cameraSystem->getViewMatrix();
-        glm::mat4 projection = cameraSystem->getProjectionMatrix();
-
-        // WaveletVisualizationComponent を持つエンティティの描画
-        for (auto const& entity : entities) {
-            const auto& waveletVis = coordinator->getComponent<WaveletVisualizationComponent>(entity);
-            for (size_t i = 0; i < waveletVis.points.size(); ++i) {
-                const glm::vec3& point = waveletVis.points[i];
-                const glm::vec4& color = waveletVis.colors[i];
-
-                // 振幅閾値を超えているか確認
-                if (point.z < amplitudeThreshold)
-                    continue;
-
-                // ワールド座標からクリップ空間へ
-                glm::vec4 clipSpacePos = projection * view * glm::vec4(point, 1.0f);
-
-                // NDCに変換
-                if (clipSpacePos.w == 0.0f) continue;
-                glm::vec3 ndc = glm::vec3(clipSpacePos) / clipSpacePos.w;
-
-                // スクリーン座標に変換
-                int screenX = static_cast<int>((ndc.x + 1.0f) * 0.5f * windowWidth);
-                int screenY = static_cast<int>((1.0f - ndc.y) * 0.5f * windowHeight); // Y軸反転
-
-                // 視野外の点を描画しない
-                if (ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f || ndc.z < -1.0f || ndc.z > 1.0f)
-                    continue;
-
-                // スクリーン座標がウィンドウ内か確認
-                if (screenX < 0 || screenX >= windowWidth || screenY < 0 || screenY >= windowHeight)
-                    continue;
-
-                // 色の設定
-                SDL_SetRenderDrawColor(renderer,
-                                       static_cast<Uint8>(color.r * 255),
-                                       static_cast<Uint8>(color.g * 255),
-                                       static_cast<Uint8>(color.b * 255),
-                                       static_cast<Uint8>(color.a * 255));
-
-                // 点を描画（円形にするために複数の点を描画）
-                const int radius = 2;
-                drawCircle(screenX, screenY, radius);
+        // 可視化データ・カメラ・画面サイズ・閾値のどれかが変わったときだけ投影し直す
+        ECS::ChangeTick since = lastProjectedTick;
+        lastProjectedTick = coordinator->advanceChangeTick();
+        if (projectionDirty ||
+            coordinator->anyChangedSince<WaveletVisualizationComponent>(since) ||
+            coordinator->anyChangedSince<CameraComponent>(since) ||
+            coordinator->anyChangedSince<ProjectionComponent>(since)) {
+            projectionDirty = false;
+            projectVisiblePoints();
+        }
 
-                // 座標ラベルの描画
-                renderCoordinateLabel(point, screenX, screenY);
-            }
+        // 点は色ごとに呼び出しを分けず、頂点色つきの四角形として一度の SDL_RenderGeometry で描く
+        if (!pointVertices.empty() &&
+            SDL_RenderGeometry(renderer, nullptr, pointVertices.data(), static_cast<int>(pointVertices.size()),
+                               pointIndices.data(), static_cast<int>(visiblePoints.size() * POINT_QUADS * 6)) != 0) {
+            SDL_Log("SDL_RenderGeometry failed: %s", SDL_GetError());
         }
 
-        SDL_Log("WaveletVisualizationSystem: Render complete.");
+        // 座標ラベルはカメラに近い順に、重ならないものを上限まで置く（字形の四角形として溜めてまとめて描く）
+        labelArena.reset();
+        int lineHeight = glyphAtlas->getLineHeight();
+        std::string_view text;
+        labelPlacer.place(windowWidth, windowHeight, visibleDepths.data(), visiblePoints.size(),
+            [&](std::size_t k) {
+                const VisiblePoint& visiblePoint = visiblePoints[k];
+                text = Text::formatCoordinates(labelArena, visiblePoint.point.x, visiblePoint.point.y, visiblePoint.point.z);
+                return Text::LabelPlacer::Rect{ visiblePoint.screenX + 5, visiblePoint.screenY - lineHeight - 5,
+                                                glyphAtlas->textWidth(text), lineHeight };
+            },
+            [&](std::size_t k) {
+                labelBatch.add(*glyphAtlas, text, visiblePoints[k].screenX + 5, visiblePoints[k].screenY - lineHeight - 5,
+                               SDL_Color{ 255, 255, 255, 255 });
+            });
+        labelBatch.flush(renderer, *glyphAtlas);
     }
 
 private:
@@ -133,61 +115,107 @@ private:
     int windowWidth;
     int windowHeight;
     CameraSystem* cameraSystem;
-    TTF_Font* font; // フォント
+    const Text::GlyphAtlas* glyphAtlas; // 座標ラベルの字形
     float amplitudeThreshold; // 座標ラベル表示の閾値
 
-    // 座標ラベルを描画する関数
-    void renderCoordinateLabel(const glm::vec3& position, int screenX, int screenY) {
-        if (!font) return;
+    // 投影済みで画面内にある点（変更が無ければフレーム間で使い回す）
+    struct VisiblePoint {
+        glm::vec3 point;
+        glm::vec4 color;
+        int screenX;
+        int screenY;
+    };
+    std::vector<VisiblePoint> visiblePoints;
+    // visiblePoints と同じ並びの奥行き（ラベルの優先度）
+    std::vector<float> visibleDepths;
+
+    // 投影前の候補（閾値を超えた点）。バッファはフレーム間で使い回す
+    struct Candidate {
+        glm::vec3 point;
+        glm::vec4 color;
+    };
+    std::vector<float> candidateXs;
+    std::vector<float> candidateYs;
+    std::vector<float> candidateZs;
+    std::vector<Candidate> candidates;
+    Simd::ScreenProjection screenPoints;
+    // 点一つあたりの四角形の数（buildPointGeometry を参照）
+    static constexpr std::size_t POINT_QUADS = 3;
+    // 見えている点の四角形（頂点色つき）と、その三角形の添字
+    std::vector<SDL_Vertex> pointVertices;
+    std::vector<int> pointIndices;
+    // 座標ラベルの頂点と文字列（フレーム間で使い回す）
+    Text::TextBatch labelBatch;
+    Text::FrameArena labelArena;
+    Text::LabelPlacer labelPlacer;
+    ECS::ChangeTick lastProjectedTick = 0;
+    bool projectionDirty = true;
+
+    void projectVisiblePoints() {
+        visiblePoints.clear();
+        visibleDepths.clear();
+        candidateXs.clear();
+        candidateYs.clear();
+        candidateZs.clear();
+        candidates.clear();
+
+        // 振幅閾値を超えた点だけを SoA のストリームに集めてから、RenderSystem と同じ段でまとめて投影する
+        coordinator->view<WaveletVisualizationComponent>().each([&](const WaveletVisualizationComponent& waveletVis) {
+            for (size_t i = 0; i < waveletVis.points.size(); ++i) {
+                const glm::vec3& point = waveletVis.points[i];
+                if (point.z < amplitudeThreshold)
+                    continue;
+                candidateXs.push_back(point.x);
+                candidateYs.push_back(point.y);
+                candidateZs.push_back(point.z);
+                candidates.push_back(Candidate{point, waveletVis.colors[i]});
+            }
+        });
 
-        // テキスト内容を作成
-        std::string text = "(" + std::to_string(position.x) + ", " +
-                            std::to_string(position.y) + ", " +
-                            std::to_string(position.z) + ")";
+        ECS::Float3Streams streams{candidateXs.data(), candidateYs.data(), candidateZs.data()};
+        screenPoints.project(streams, candidates.size(), cameraSystem->getScreenTransform(windowWidth, windowHeight));
 
-        // テキストをサーフェスにレンダリング
-        SDL_Color textColor = { 255, 255, 255, 255 }; // 白色
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, text.c_str(), textColor);
-        if (!textSurface) {
-            SDL_Log("Failed to render text surface: %s", TTF_GetError());
-            return;
+        const std::uint32_t* indices = screenPoints.indices();
+        for (std::size_t k = 0; k < screenPoints.size(); ++k) {
+            const Candidate& candidate = candidates[indices[k]];
+            visiblePoints.push_back(VisiblePoint{candidate.point, candidate.color,
+                                                 screenPoints.screenX()[k], screenPoints.screenY()[k]});
+            visibleDepths.push_back(screenPoints.depth()[k]);
         }
+        buildPointGeometry();
+    }
 
-        // サーフェスをテクスチャに変換
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        if (!textTexture) {
-            SDL_Log("Failed to create text texture: %s", SDL_GetError());
-            SDL_FreeSurface(textSurface);
-            return;
+    // 見えている点ごとに、半径 2 の円を重ならない三つの四角形で頂点バッファへ並べる
+    // 円の画素は (x, y) を中心とする 3x3 と、その右 (x+2, y) と下 (x, y+2) の 1 画素ずつ
+    // 添字は点の並びによらず同じ形なので、足りなくなったときだけ伸ばす
+    void buildPointGeometry() {
+        pointVertices.resize(visiblePoints.size() * POINT_QUADS * 4);
+        for (std::size_t k = 0; k < visiblePoints.size(); ++k) {
+            const VisiblePoint& visiblePoint = visiblePoints[k];
+            const glm::vec4& color = visiblePoint.color;
+            SDL_Color vertexColor = { static_cast<Uint8>(color.r * 255),
+                                      static_cast<Uint8>(color.g * 255),
+                                      static_cast<Uint8>(color.b * 255),
+                                      static_cast<Uint8>(color.a * 255) };
+            float x = static_cast<float>(visiblePoint.screenX);
+            float y = static_cast<float>(visiblePoint.screenY);
+            SDL_Vertex* quads = &pointVertices[k * POINT_QUADS * 4];
+            setQuad(quads, x - 1.0f, y - 1.0f, x + 2.0f, y + 2.0f, vertexColor);  // 3x3
+            setQuad(quads + 4, x + 2.0f, y, x + 3.0f, y + 1.0f, vertexColor);     // 右
+            setQuad(quads + 8, x, y + 2.0f, x + 1.0f, y + 3.0f, vertexColor);     // 下
         }
 
-        // テクスチャのサイズを取得
-        int textWidth = textSurface->w;
-        int textHeight = textSurface->h;
-
-        // テクスチャの描画位置を設定（点の右下に表示）
-        SDL_Rect renderQuad = { screenX + 5, screenY - textHeight - 5, textWidth, textHeight };
-
-        // テクスチャをレンダラーにコピー
-        if (SDL_RenderCopy(renderer, textTexture, NULL, &renderQuad) != 0) {
-            SDL_Log("Failed to render text texture: %s", SDL_GetError());
+        for (std::size_t k = pointIndices.size() / 6; k < visiblePoints.size() * POINT_QUADS; ++k) {
+            int base = static_cast<int>(k * 4);
+            pointIndices.insert(pointIndices.end(), { base, base + 1, base + 2, base + 2, base + 3, base });
         }
-
-        // リソースの解放
-        SDL_DestroyTexture(textTexture);
-        SDL_FreeSurface(textSurface);
     }
 
-    // 点を円形に描画する補助関数
-    void drawCircle(int x, int y, int radius) {
-        for (int w = 0; w < radius * 2; w++) {
-            for (int h = 0; h < radius * 2; h++) {
-                int dx = radius - w; // 左からの距離
-                int dy = radius - h; // 上からの距離
-                if ((dx*dx + dy*dy) <= (radius * radius)) {
-                    SDL_RenderDrawPoint(renderer, x + dx, y + dy);
-                }
-            }
-        }
+    static void setQuad(SDL_Vertex* quad, float left, float top, float right, float bottom, SDL_Color color) {
+        quad[0] = SDL_Vertex{ SDL_FPoint{left, top}, color, SDL_FPoint{0.0f, 0.0f} };
+        quad[1] = SDL_Vertex{ SDL_FPoint{right, top}, color, SDL_FPoint{0.0f, 0.0f} };
+        quad[2] = SDL_Vertex{ SDL_FPoint{right, bottom}, color, SDL_FPoint{0.0f, 0.0f} };
+        quad[3] = SDL_Vertex{ SDL_FPoint{left, bottom}, color, SDL_FPoint{0.0f, 0.0f} };
     }
+
 };
@@ -3,14 +3,26 @@
 #include <SDL2/SDL_ttf.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
+#include <random>
+#include <string>
+#include <vector>
 #include "Engine/ECS/Coordinator.hpp"
+#include "Engine/ECS/Scheduler.hpp"
+#include "Engine/Jobs/ThreadPool.hpp"
+#include "Engine/Jobs/TaskGroup.hpp"
 #include "Engine/Events/EventManager.hpp"
+#include "Engine/Events/TimerWheel.hpp"
+#include "Engine/Replay/SessionLog.hpp"
+#include "Engine/Replay/FrameTimeStats.hpp"
+#include "Engine/Text/GlyphAtlas.hpp"
 #include "Systems/MovementSystem.hpp"
 #include "Systems/RenderSystem.hpp"
 #include "Systems/MorphingSystem.hpp"
 #include "Systems/CameraSystem.hpp"
+#include "Systems/SpatialSortSystem.hpp"
 #include "Components/PositionComponent.hpp"
 #include "Components/VelocityComponent.hpp"
 #include "Components/FunctionComponent.hpp"
@@ -34,9 +46,13 @@ enum class CoordinateSystemType {
 // 現在の座標系を追跡
 CoordinateSystemType currentCoordinateSystem = CoordinateSystemType::Cartesian;
 
-// グローバル変数としてCoordinatorとEventManagerを宣言
+// グローバル変数としてCoordinator、EventManager、TimerWheel、ThreadPoolを宣言
 ECS::Coordinator coordinator;
 EventManager eventManager;
+TimerWheel timerWheel;
+Jobs::ThreadPool threadPool;
+// 進行中のモーフの完了タイマー
+TimerId morphTimer;
 
 // カメラの初期設定
 void setupCamera(ECS::Entity entity) {
@@ -60,18 +76,31 @@ void setupCamera(ECS::Entity entity) {
 
 // ランダム速度を割り当てる関数の実装
 void assignRandomVelocities() {
-    for (ECS::Entity entity = 0; entity < ECS::MAX_ENTITIES; ++entity) {
-        if (coordinator.hasComponent<VelocityComponent>(entity)) {
-            auto& velocity = coordinator.getComponent<VelocityComponent>(entity).velocity;
-            velocity = glm::vec3(
-                (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 1.0f, // -0.5 to 0.5
-                (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 1.0f,
-                (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 1.0f
-            );
-        }
-    }
+    coordinator.view<VelocityComponent>().each([](ECS::ComponentRef<VelocityComponent> velocityComponent) {
+        velocityComponent.velocity = glm::vec3(
+            (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 1.0f, // -0.5 to 0.5
+            (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 1.0f,
+            (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 1.0f
+        );
+    });
+    coordinator.markAllChanged<VelocityComponent>();
     SDL_Log("Assigned random velocities to all entities.");
 }
+// 完了したモーフを目標位置に揃え、MorphingComponent をまとめて外す
+void finishMorphs() {
+    std::vector<ECS::Entity> finished;
+    coordinator.view<MorphingComponent, PositionComponent>().each(
+        [&](ECS::Entity entity, MorphingComponent& morph, ECS::ComponentRef<PositionComponent> positionComponent) {
+            positionComponent.position = morph.targetPosition;
+            coordinator.markChanged<PositionComponent>(entity);
+            finished.push_back(entity);
+        });
+    for (ECS::Entity entity : finished) {
+        coordinator.removeComponent<MorphingComponent>(entity);
+    }
+    SDL_Log("Morphing complete for %zu entities.", finished.size());
+}
+
 void switchCoordinateSystemMorph() {
     // ターゲット座標系を決定
     CoordinateSystemType targetCoordinateSystem;
@@ -83,51 +112,71 @@ void switchCoordinateSystemMorph() {
 
     // モーフの総時間（秒）
     float morphDuration = 2.0f;
+    double startTime = timerWheel.getTime();
 
     // すべてのエンティティを対象にモーフィングを設定
-    for (ECS::Entity entity = 0; entity < ECS::MAX_ENTITIES; ++entity) {
-        if (coordinator.hasComponent<PositionComponent>(entity)) {
-            glm::vec3 currentPos = coordinator.getComponent<PositionComponent>(entity).position;
-            glm::vec3 targetPos;
-
-            if (targetCoordinateSystem == CoordinateSystemType::Polar) {
-                // 直交座標系から極座標系への変換
-                float r = glm::length(glm::vec2(currentPos.x, currentPos.y));
-                float theta = atan2(currentPos.y, currentPos.x);
-                float phi = currentPos.z; // 3Dの場合は適宜設定
-
-                // 視覚的に極座標系を表現するために、rをx軸、thetaをy軸、phiをz軸として設定
-                targetPos = glm::vec3(r, theta, phi);
-            } else {
-                // 極座標系から直交座標系への変換
-                // x = r * cos(theta), y = r * sin(theta), z = phi
-                float r = currentPos.x;
-                float theta = currentPos.y;
-                float phi = currentPos.z;
-
-                targetPos = glm::vec3(r * cos(theta), r * sin(theta), phi);
-            }
+    // 変換はワーカーに分割して計算し、新しく必要な MorphingComponent は区間ごとに集めて後でまとめて追加する
+    auto pointView = coordinator.view<PositionComponent>().optional<MorphingComponent>();
+    const std::size_t chunkSize = Jobs::DEFAULT_CHUNK_SIZE;
+    std::size_t pointCount = pointView.sizeHint();
+    std::size_t chunkCount = (pointCount + chunkSize - 1) / chunkSize;
+    std::vector<std::vector<ECS::Entity>> morphEntities(chunkCount);
+    std::vector<std::vector<MorphingComponent>> morphComponents(chunkCount);
+
+    Jobs::parallelFor(threadPool, 0, pointCount, chunkSize, [&](std::size_t begin, std::size_t end) {
+        std::size_t chunk = begin / chunkSize;
+        pointView.eachInRange(begin, end,
+                              [&](ECS::Entity entity, ECS::ComponentRef<PositionComponent> positionComponent, MorphingComponent* existingMorph) {
+                glm::vec3 currentPos = positionComponent.position;
+                glm::vec3 targetPos;
+
+                if (targetCoordinateSystem == CoordinateSystemType::Polar) {
+                    // 直交座標系から極座標系への変換
+                    float r = glm::length(glm::vec2(currentPos.x, currentPos.y));
+                    float theta = atan2(currentPos.y, currentPos.x);
+                    float phi = currentPos.z; // 3Dの場合は適宜設定
+
+                    // 視覚的に極座標系を表現するために、rをx軸、thetaをy軸、phiをz軸として設定
+                    targetPos = glm::vec3(r, theta, phi);
+                } else {
+                    // 極座標系から直交座標系への変換
+                    // x = r * cos(theta), y = r * sin(theta), z = phi
+                    float r = currentPos.x;
+                    float theta = currentPos.y;
+                    float phi = currentPos.z;
+
+                    targetPos = glm::vec3(r * cos(theta), r * sin(theta), phi);
+                }
 
-            // MorphingComponent を追加または更新
-            if (coordinator.hasComponent<MorphingComponent>(entity)) {
-                // 既存の MorphingComponent を更新
-                auto& morph = coordinator.getComponent<MorphingComponent>(entity);
-                morph.startPosition = currentPos;
-                morph.targetPosition = targetPos;
-                morph.duration = morphDuration;
-                morph.elapsed = 0.0f;
-            } else {
-                // 新たに MorphingComponent を追加
-                coordinator.addComponent<MorphingComponent>(entity, MorphingComponent{
-                    currentPos,
-                    targetPos,
-                    morphDuration,
-                    0.0f
-                });
-            }
-        }
+                // MorphingComponent を追加または更新
+                if (existingMorph) {
+                    // 既存の MorphingComponent を更新
+                    auto& morph = *existingMorph;
+                    morph.startPosition = currentPos;
+                    morph.targetPosition = targetPos;
+                    morph.duration = morphDuration;
+                    morph.startTime = startTime;
+                } else {
+                    // 新たに MorphingComponent を追加（区間ごとに集める）
+                    morphEntities[chunk].push_back(entity);
+                    morphComponents[chunk].push_back(MorphingComponent{
+                        currentPos,
+                        targetPos,
+                        morphDuration,
+                        startTime
+                    });
+                }
+            });
+    });
+
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        coordinator.addComponents<MorphingComponent>(morphEntities[chunk], morphComponents[chunk]);
     }
 
+    // 完了時にまとめて後始末する（途中で切り替え直したら前の予約は取り消す）
+    timerWheel.cancel(morphTimer);
+    morphTimer = timerWheel.schedule(morphDuration, finishMorphs);
+
     // 現在の座標系を更新
     currentCoordinateSystem = targetCoordinateSystem;
 
@@ -137,8 +186,10 @@ void switchCoordinateSystemMorph() {
 
 // 点群の生成処理
 void generatePointCloud(int numPoints) {
+    // コンポーネントを先に用意し、エンティティ生成と追加をまとめて行う
+    std::vector<PositionComponent> positions(numPoints);
+    std::vector<VelocityComponent> velocities(numPoints);
     for (int i = 0; i < numPoints; ++i) {
-        ECS::Entity entity = coordinator.createEntity();
         glm::vec3 position(
             static_cast<float>(rand()) / RAND_MAX * 10.0f - 5.0f, // -5 to 5
             static_cast<float>(rand()) / RAND_MAX * 10.0f - 5.0f, // -5 to 5
@@ -150,10 +201,13 @@ void generatePointCloud(int numPoints) {
             (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 0.1f
         );
 
-        coordinator.addComponent(entity, PositionComponent{position});
-        coordinator.addComponent(entity, VelocityComponent{velocity});
+        positions[i] = PositionComponent{position};
+        velocities[i] = VelocityComponent{velocity};
     }
 
+    std::vector<ECS::Entity> entities = coordinator.createEntities(numPoints);
+    coordinator.addComponents<PositionComponent, VelocityComponent>(entities, positions, velocities);
+
     SDL_Log("Generated %d point entities.", numPoints);
 }
 
@@ -163,6 +217,47 @@ void generateSamplePoint(ECS::Entity entity, glm::vec3 position) {
 }
 
 int main(int argc, char* argv[]) {
+    // --record <file>: 入力・イベント・経過時間・乱数の種を記録する
+    // --replay <file> [--fast]: 記録を再生する（--fast は待たずに最速で回す）
+    // --software: 点群を CPU のタイル分割ラスタライザで描く
+    std::string recordPath;
+    std::string replayPath;
+    bool replayFast = false;
+    bool softwareRaster = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (argument == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (argument == "--fast") {
+            replayFast = true;
+        } else if (argument == "--software") {
+            softwareRaster = true;
+        } else {
+            SDL_Log("Unknown argument: %s", argument.c_str());
+        }
+    }
+
+    Replay::SessionPlayer player;
+    bool replaying = !replayPath.empty();
+    if (replaying && !player.open(replayPath)) {
+        SDL_Log("Failed to open replay %s: %s", replayPath.c_str(), player.getError().c_str());
+        return -1;
+    }
+
+    // 乱数の種は再生なら記録から、それ以外は毎回新しく決める
+    std::uint64_t sessionSeed = replaying ? player.getSeed() : std::random_device{}();
+    std::srand(static_cast<unsigned int>(sessionSeed));
+
+    Replay::SessionRecorder recorder;
+    if (!recordPath.empty()) {
+        if (!recorder.open(recordPath, sessionSeed)) {
+            SDL_Log("Failed to open %s for recording.", recordPath.c_str());
+            return -1;
+        }
+        SDL_Log("Recording session to %s.", recordPath.c_str());
+    }
     // SDLとTTFの初期化
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
@@ -193,8 +288,12 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
-    // レンダラーの作成（垂直同期を有効にする）
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    // レンダラーの作成（垂直同期を有効にする。最速の再生では無効）
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (!(replaying && replayFast)) {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (!renderer) {
         SDL_Log("Failed to create renderer: %s", SDL_GetError());
         SDL_DestroyWindow(window);
@@ -203,7 +302,11 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
+    // 座標ラベルの字形（RenderSystem と WaveletVisualizationSystem で共有する）
+    Text::GlyphAtlas glyphAtlas;
+
     // ECSの初期化
+    // 移動・描画・空間整列はビューの SoA ストリームと並べ替えを使うので、疎集合方式（既定）で動かす
     coordinator.init();
 
     // コンポーネントの登録
@@ -224,6 +327,11 @@ int main(int argc, char* argv[]) {
         signature.set(coordinator.getComponentType<PositionComponent>(), true);
         signature.set(coordinator.getComponentType<VelocityComponent>(), true); // VelocityComponentが必要な場合
         movementSystem->setCoordinator(&coordinator);
+        movementSystem->setThreadPool(&threadPool);
+        movementSystem->setRandomSeed(sessionSeed);
+        SDL_Log("MovementSystem: using %s integration kernel.", Simd::integrateKernel().name);
+        // 領域外に出た点は破棄せず、初期生成と同じ分布で再出現させて点数を保つ
+        movementSystem->setBoundaryMode(MovementSystem::BoundaryMode::Recycle);
         coordinator.setSystemSignature<MovementSystem>(signature);
     }
 
@@ -232,13 +340,18 @@ int main(int argc, char* argv[]) {
         ECS::Signature signature;
         signature.set(coordinator.getComponentType<PositionComponent>(), true);
         renderSystem->setCoordinator(&coordinator);
+        renderSystem->setThreadPool(&threadPool);
         renderSystem->setRenderer(renderer);
         renderSystem->setWindowSize(windowWidth, windowHeight);
+        renderSystem->setGlyphAtlas(&glyphAtlas);
+        if (softwareRaster) {
+            renderSystem->setBackend(RenderSystem::Backend::Software);
+        }
         coordinator.setSystemSignature<RenderSystem>(signature);
-                // フォントのロード
+        // 座標ラベルの字形を一度だけ作り、WaveletVisualizationSystem と共有する
         std::string fontPath = "JetBrainsMonoNL-Regular.ttf"; // フォントファイルのパスを指定
         int fontSize = 12; // フォントサイズを指定
-        if (!renderSystem->loadFont(fontPath, fontSize)) {
+        if (!glyphAtlas.load(renderer, fontPath, fontSize)) {
             SDL_Log("Failed to load font. Exiting.");
             // 必要に応じてエラーハンドリング（例: アプリケーションを終了）
             // Clean up and exit
@@ -255,15 +368,27 @@ int main(int argc, char* argv[]) {
         ECS::Signature signature;
         signature.set(coordinator.getComponentType<MorphingComponent>(), true);
         morphingSystem->setCoordinator(&coordinator);
+        morphingSystem->setClock(&timerWheel);
         coordinator.setSystemSignature<MorphingSystem>(signature);
     }
 
+    auto spatialSortSystem = coordinator.registerSystem<SpatialSortSystem>();
+    {
+        ECS::Signature signature;
+        signature.set(coordinator.getComponentType<PositionComponent>(), true);
+        spatialSortSystem->setCoordinator(&coordinator);
+        // 点は動き続けるので、数秒おきに Z 順序へ並べ直す
+        timerWheel.schedule(5.0f, [spatialSortSystem]() { spatialSortSystem->requestSort(); }, 5.0f);
+        coordinator.setSystemSignature<SpatialSortSystem>(signature);
+    }
+
     auto cameraSystem = coordinator.registerSystem<CameraSystem>(); // CameraSystem の登録
     {
         ECS::Signature signature;
         signature.set(coordinator.getComponentType<CameraComponent>(), true);
         signature.set(coordinator.getComponentType<ProjectionComponent>(), true);
         cameraSystem->setCoordinator(&coordinator);
+        cameraSystem->setEventManager(&eventManager);
         coordinator.setSystemSignature<CameraSystem>(signature);
     }
     // AudioSystem の登録
@@ -295,18 +420,7 @@ int main(int argc, char* argv[]) {
         waveletVisSystem->setRenderer(renderer);
         waveletVisSystem->setWindowSize(windowWidth, windowHeight);
         waveletVisSystem->setCameraSystem(cameraSystem.get());
-
-        // フォントのロード（RenderSystemと共有する場合は省略可）
-        std::string fontPath = "JetBrainsMonoNL-Regular.ttf"; // フォントファイルのパスを指定
-        int fontSize = 12; // フォントサイズを指定
-        if (!waveletVisSystem->loadFont(fontPath, fontSize)) {
-            SDL_Log("Failed to load font for WaveletVisualizationSystem. Exiting.");
-            SDL_DestroyRenderer(renderer);
-            SDL_DestroyWindow(window);
-            TTF_Quit();
-            SDL_Quit();
-            return -1;
-        }
+        waveletVisSystem->setGlyphAtlas(&glyphAtlas);
 
         coordinator.setSystemSignature<WaveletVisualizationSystem>(signature);
     }
@@ -318,9 +432,31 @@ int main(int argc, char* argv[]) {
     // RenderSystem に CameraSystem の参照を設定
     renderSystem->setCameraSystem(cameraSystem.get());
 
+    // 更新系システムのスケジューラ（読み書きが衝突しないものはワーカーで並列に走る）
+    // 描画系はレンダラーを使うため、メインループ内でこれまでどおり順に呼ぶ
+    ECS::Scheduler scheduler(coordinator, threadPool);
+    // Movement は pack() で Velocity の配列も並べ替えるので書き込み扱いにする
+    scheduler.addSystem("Movement",
+                        ECS::Reads<>{}, ECS::Writes<PositionComponent, VelocityComponent>{},
+                        [movementSystem](float dt) { movementSystem->update(dt); });
+    scheduler.addSystem("Morphing",
+                        ECS::Reads<MorphingComponent>{}, ECS::Writes<PositionComponent>{},
+                        [morphingSystem](float dt) { morphingSystem->update(dt); });
+    // 点の配列を並べ替えるので、点を読み書きする他のシステムとは重ならない
+    scheduler.addSystem("SpatialSort",
+                        ECS::Reads<>{}, ECS::Writes<PositionComponent, VelocityComponent, MorphingComponent>{},
+                        [spatialSortSystem](float dt) { spatialSortSystem->update(dt); });
+    scheduler.addSystem("Audio",
+                        ECS::Reads<>{}, ECS::Writes<AudioComponent>{},
+                        [audioSystem](float dt) { audioSystem->update(dt); });
+    scheduler.addSystem("Wavelet",
+                        ECS::Reads<AudioComponent>{}, ECS::Writes<WaveletComponent>{},
+                        [waveletSystem](float dt) { waveletSystem->update(dt); });
+
     // 初期点群の生成（テスト用）
     generatePointCloud(1000);
     SDL_Log("Initial point cloud generated.");
+    spatialSortSystem->requestSort();
 
     // サンプルポイントの生成
     ECS::Entity sampleEntity = coordinator.createEntity();
@@ -328,12 +464,29 @@ int main(int argc, char* argv[]) {
     SDL_Log("Sample point at origin generated.");
 
     // イベントリスナーの設定
-    eventManager.addListener(Event::GeneratePointCloud, [](const Event&) {
-        generatePointCloud(1000);
+    // 連打や連続したマウス操作はフレームごとに1件へまとめてから処理する
+    eventManager.setCoalescing(Event::GeneratePointCloud, EventManager::Coalesce::Accumulate);
+    eventManager.setCoalescing(Event::SwitchCoordinateSystem, EventManager::Coalesce::Accumulate);
+    eventManager.setCoalescing(Event::CameraOrbit, EventManager::Coalesce::Accumulate);
+
+    eventManager.addListener(Event::GeneratePointCloud, [spatialSortSystem](const Event& event) {
+        // 同じフレームの要求は点数を合計して一度に生成する
+        const auto* request = event.get<GeneratePointCloudPayload>();
+        generatePointCloud(request ? static_cast<int>(request->count) : 1000);
+        spatialSortSystem->requestSort();
+    });
+
+    eventManager.addListener(Event::SwitchCoordinateSystem, [](const Event& event) {
+        // 偶数回の切り替えは元に戻るだけなので何もしない
+        if (event.count % 2 == 1) {
+            switchCoordinateSystemMorph(); // 座標系の切り替えをモーフィングで実行
+        }
     });
 
-    eventManager.addListener(Event::SwitchCoordinateSystem, [](const Event&) {
-        switchCoordinateSystemMorph(); // 座標系の切り替えをモーフィングで実行
+    eventManager.addListener(Event::CameraOrbit, [cameraSystem](const Event& event) {
+        if (const auto* delta = event.get<CameraOrbitPayload>()) {
+            cameraSystem->orbit(*delta);
+        }
     });
 
     // GUIマネージャの初期化
@@ -341,7 +494,7 @@ int main(int argc, char* argv[]) {
 
     // GUI要素の追加
     guiManager.addElement(new Button("Generate", 10, 10, 100, 30, []() {
-        eventManager.sendEvent(Event{Event::GeneratePointCloud});
+        eventManager.sendEvent(Event{Event::GeneratePointCloud, GeneratePointCloudPayload{1000}});
     }));
 
     guiManager.addElement(new Button("Switch Coordinate", 120, 10, 150, 30, []() {
@@ -352,34 +505,77 @@ int main(int argc, char* argv[]) {
         assignRandomVelocities();
     }));
 
-    guiManager.addElement(new Button("Load Audio", 440, 10, 120, 30, [audioSystem]() {
+    // 音声エンティティは世代付きハンドルで保持し、破棄済みなら作り直す
+    ECS::EntityHandle audioHandle{};
+    guiManager.addElement(new Button("Load Audio", 440, 10, 120, 30, [audioSystem, &audioHandle]() {
         // ファイル選択ダイアログを開く（簡易的に固定パスを使用）
         std::string audioPath = "assets/audio/in.wav"; // 実際にはファイル選択ダイアログを実装することを推奨
-        ECS::Entity audioEntity = coordinator.createEntity();
+        bool created = !coordinator.isAlive(audioHandle);
+        if (created) {
+            audioHandle = coordinator.getHandle(coordinator.createEntity());
+        }
+        ECS::Entity audioEntity = coordinator.resolve(audioHandle);
         if (audioSystem->loadAudioFile(audioPath, audioEntity)) {
             SDL_Log("Audio file loaded and assigned to entity %d.", audioEntity);
+        } else if (created) {
+            // 読み込みに失敗したら空のエンティティを残さない
+            coordinator.destroyEntity(audioEntity);
+            audioHandle = ECS::EntityHandle{};
         }
     }));
     // ボタンの追加
     guiManager.addElement(new Button("Wavelet Transform", 440, 50, 150, 30, [waveletSystem]() {
         // 音声エンティティを取得（ここでは単一エンティティと仮定）
         // 複数エンティティに対応する場合はループを使用
-        for (ECS::Entity entity = 0; entity < ECS::MAX_ENTITIES; ++entity) {
-            if (coordinator.hasComponent<AudioComponent>(entity)) {
-                waveletSystem->performWaveletTransform(entity);
-            }
-        }
+        coordinator.view<AudioComponent>().each([&](ECS::Entity entity, AudioComponent&) {
+            waveletSystem->performWaveletTransform(entity);
+        });
     }));
 
     guiManager.addElement(new Button("Inverse Wavelet", 600, 50, 150, 30, [waveletSystem]() {
         // ウェーブレット変換されたエンティティを取得
-        for (ECS::Entity entity = 0; entity < ECS::MAX_ENTITIES; ++entity) {
-            if (coordinator.hasComponent<WaveletComponent>(entity)) {
-                waveletSystem->performInverseWaveletTransform(entity);
+        coordinator.view<WaveletComponent>().each([&](ECS::Entity entity, WaveletComponent&) {
+            waveletSystem->performInverseWaveletTransform(entity);
+        });
+    }));
+
+
+    // 入力1件の処理（実際の入力と再生した入力で共通）
+    auto handleInput = [&](const SDL_Event& input) {
+        // ウィンドウサイズ変更の処理
+        if (input.type == SDL_WINDOWEVENT) {
+            if (input.window.event == SDL_WINDOWEVENT_RESIZED) {
+                windowWidth = input.window.data1;
+                windowHeight = input.window.data2;
+                renderSystem->setWindowSize(windowWidth, windowHeight);
+                waveletVisSystem->setWindowSize(windowWidth, windowHeight);
+
+                // ProjectionComponent のアスペクト比を更新
+                coordinator.view<ProjectionComponent>().each([&](ProjectionComponent& proj) {
+                    proj.aspectRatio = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
+                });
+                coordinator.markAllChanged<ProjectionComponent>();
             }
         }
-    }));
 
+        // GUIイベントの処理
+        guiManager.handleEvent(input);
+
+        // CameraSystem のマウスイベントの処理
+        cameraSystem->handleMouseEvent(input);
+    };
+
+    // 記録中は配ったイベントを書き出し、再生中は記録と照合する
+    std::vector<Event> dispatchedEvents;
+    if (recorder.isOpen() || replaying) {
+        eventManager.setDispatchObserver([&dispatchedEvents](const Event& dispatched) {
+            dispatchedEvents.push_back(dispatched);
+        });
+    }
+    Replay::FrameRecord replayFrame;
+    bool replayDiverged = false;
+    Replay::FrameTimeStats frameTimes;
+    const double counterFrequency = static_cast<double>(SDL_GetPerformanceFrequency());
 
     // メインループ
     bool running = true;
@@ -387,45 +583,68 @@ int main(int argc, char* argv[]) {
     Uint32 lastTime = SDL_GetTicks();
 
     while (running) {
+        Uint64 frameStart = SDL_GetPerformanceCounter();
         Uint32 currentTime = SDL_GetTicks();
         float deltaTime = (currentTime - lastTime) / 1000.0f;
         lastTime = currentTime;
 
+        // 再生中は記録した経過時間と入力を使う（ウィンドウへの実際の入力は終了以外は無視する）
+        if (replaying) {
+            if (!player.nextFrame(replayFrame)) {
+                break;
+            }
+            deltaTime = replayFrame.deltaTime;
+        }
+        if (recorder.isOpen()) {
+            recorder.beginFrame(deltaTime);
+        }
+
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
             }
-
-            // ウィンドウサイズ変更の処理
-            if (event.type == SDL_WINDOWEVENT) {
-                if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                    windowWidth = event.window.data1;
-                    windowHeight = event.window.data2;
-                    renderSystem->setWindowSize(windowWidth, windowHeight);
-
-                    // ProjectionComponent のアスペクト比を更新
-                    for (ECS::Entity entity = 0; entity < ECS::MAX_ENTITIES; ++entity) {
-                        if (coordinator.hasComponent<ProjectionComponent>(entity)) {
-                            auto& proj = coordinator.getComponent<ProjectionComponent>(entity);
-                            proj.aspectRatio = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
-                        }
-                    }
+            if (replaying) {
+                continue;
+            }
+            if (recorder.isOpen()) {
+                recorder.recordInput(event);
+            }
+            handleInput(event);
+        }
+        if (replaying) {
+            for (const SDL_Event& input : replayFrame.inputs) {
+                if (input.type == SDL_QUIT) {
+                    running = false;
                 }
+                handleInput(input);
             }
-
-            // GUIイベントの処理
-            guiManager.handleEvent(event);
-
-            // CameraSystem のマウスイベントの処理
-            cameraSystem->handleMouseEvent(event);
         }
 
+        // 期限を迎えたタイマーをまとめて実行する（イベントを送るものは下の processEvents で配られる）
+        timerWheel.advance(deltaTime);
+
         // システムの更新
-        movementSystem->update(deltaTime);
-        morphingSystem->update(deltaTime);
+        scheduler.run(deltaTime);
+
+        // システムが記録した構造変更をまとめて反映（同期点）
+        coordinator.flushCommands();
 
-        // イベントの処理
+        // イベントの処理（ワーカーから送られたものも含めてここで配る）
+        dispatchedEvents.clear();
         eventManager.processEvents();
+        if (std::size_t dropped = eventManager.takeDroppedCount()) {
+            SDL_Log("EventManager: %zu events dropped because the queue was full.", dropped);
+        }
+        if (recorder.isOpen()) {
+            for (const Event& dispatched : dispatchedEvents) {
+                recorder.recordEvent(dispatched);
+            }
+            recorder.endFrame();
+        }
+        if (replaying && !replayDiverged && dispatchedEvents != replayFrame.events) {
+            replayDiverged = true;
+            SDL_Log("Replay: events diverged from the recording at frame %zu.", player.getFrameCount());
+        }
 
         // 描画処理の開始
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // 背景色を黒に設定
@@ -437,12 +656,36 @@ int main(int argc, char* argv[]) {
 
         // GUIの描画
         guiManager.render();
-        cameraSystem->handleMouseEvent(event);
         // レンダリングの表示
         SDL_RenderPresent(renderer);
+
+        double frameMs = static_cast<double>(SDL_GetPerformanceCounter() - frameStart) * 1000.0 / counterFrequency;
+        frameTimes.add(frameMs);
+
+        // 実時間での再生は記録時の間隔に合わせて待つ
+        if (replaying && !replayFast) {
+            double remainingMs = replayFrame.deltaTime * 1000.0 - frameMs;
+            if (remainingMs > 1.0) {
+                SDL_Delay(static_cast<Uint32>(remainingMs));
+            }
+        }
+    }
+
+    if (recorder.isOpen() || replaying) {
+        Replay::FrameTimeSummary summary = frameTimes.summarize();
+        SDL_Log("Frame times over %zu frames: mean %.3f ms, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms",
+                summary.frames, summary.mean, summary.p50, summary.p90, summary.p99, summary.max);
+    }
+    if (recorder.isOpen()) {
+        SDL_Log("Recorded %zu frames.", recorder.getFrameCount());
+    }
+    if (replaying) {
+        SDL_Log("Replayed %zu frames%s.", player.getFrameCount(),
+                replayDiverged ? " (diverged from the recording)" : "");
     }
 
-    // クリーンアップ
+    // クリーンアップ（字形のテクスチャはレンダラーより先に破棄する）
+    glyphAtlas.release();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     TTF_Quit();